@@ -475,7 +475,7 @@ bool Animation::loadSKANIM(const char* filename)
 }
 
 
-std::map<std::string, Animation*> Animation::sAnimationsLoaded;
+std::unordered_map<std::string, Animation*, StringIDHash> Animation::sAnimationsLoaded;
 Animation* Animation::Get(const char* filename)
 {
 	assert(filename);
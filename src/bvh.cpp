@@ -0,0 +1,314 @@
+#include "bvh.h"
+
+#include "camera.h"
+#include "mesh.h"
+#include "prefab.h"
+#include "scene.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace GTR;
+
+//merges the boxes of a range of items
+static BoundingBox computeItemsBounding(const std::vector<sBVHItem>& items, const int* indices, int count)
+{
+	Vector3 bbmin(1e20f, 1e20f, 1e20f);
+	Vector3 bbmax(-1e20f, -1e20f, -1e20f);
+	for (int i = 0; i < count; ++i)
+	{
+		const BoundingBox& box = items[indices[i]].world_bounding;
+		bbmin.setMin(box.center - box.halfsize);
+		bbmax.setMax(box.center + box.halfsize);
+	}
+	Vector3 halfsize = (bbmax - bbmin) * 0.5;
+	return BoundingBox(bbmin + halfsize, halfsize);
+}
+
+SceneBVH::SceneBVH()
+{
+	num_tested = 0;
+	num_visible = 0;
+	num_accepted = 0;
+}
+
+void SceneBVH::clear()
+{
+	items.clear();
+	indices.clear();
+	nodes.clear();
+	entities.clear();
+	dirty_nodes.clear();
+}
+
+void SceneBVH::build(Scene* scene)
+{
+	clear();
+
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+
+		sEntityInfo info;
+		info.model = ent->model;
+		info.prefab = NULL;
+		info.prefab_version = 0;
+		info.first_item = items.size();
+
+		if (ent->entity_type == PREFAB)
+		{
+			PrefabEntity* pent = (GTR::PrefabEntity*)ent;
+			info.prefab = pent->prefab;
+			if (pent->prefab)
+			{
+				info.prefab_version = pent->prefab->compiled.version;
+				addPrefabItems(ent->model, &pent->prefab->compiled, i);
+			}
+		}
+
+		info.num_items = items.size() - info.first_item;
+		entities.push_back(info);
+	}
+
+	indices.resize(items.size());
+	for (int i = 0; i < indices.size(); ++i)
+		indices[i] = i;
+
+	if (items.size())
+		buildNode(0, items.size(), -1);
+}
+
+void SceneBVH::addPrefabItems(const Matrix44& prefab_model, CompiledPrefab* compiled, int entity_index)
+{
+	for (int i = 0; i < compiled->render_nodes.size(); ++i)
+	{
+		int index = compiled->render_nodes[i];
+		if (!compiled->visible[index])
+			continue;
+
+		sBVHItem item;
+		item.node_model = compiled->models[index];
+		item.model = item.node_model * prefab_model;
+		item.world_bounding = transformBoundingBox(item.model, compiled->boxes[index]);
+		item.mesh = compiled->meshes[index];
+		item.material = compiled->materials[index];
+		item.entity_index = entity_index;
+		item.leaf = -1;
+		items.push_back(item);
+	}
+}
+
+//top-down build splitting by the median of the largest axis
+int SceneBVH::buildNode(int start, int count, int parent)
+{
+	int index = nodes.size();
+	nodes.push_back(sBVHNode());
+
+	sBVHNode& node = nodes[index];
+	node.parent = parent;
+	node.left = node.right = -1;
+	node.start = start;
+	node.count = count;
+	node.bounding = computeItemsBounding(items, &indices[start], count);
+
+	if (count <= MAX_LEAF_ITEMS)
+	{
+		for (int i = start; i < start + count; ++i)
+			items[indices[i]].leaf = index;
+		return index;
+	}
+
+	//choose the axis where the centers are more spread
+	Vector3 cmin(1e20f, 1e20f, 1e20f);
+	Vector3 cmax(-1e20f, -1e20f, -1e20f);
+	for (int i = start; i < start + count; ++i)
+	{
+		cmin.setMin(items[indices[i]].world_bounding.center);
+		cmax.setMax(items[indices[i]].world_bounding.center);
+	}
+	Vector3 extent = cmax - cmin;
+	int axis = 0;
+	if (extent.y > extent.x) axis = 1;
+	if (extent.z > extent.v[axis]) axis = 2;
+
+	int mid = start + count / 2;
+	const std::vector<sBVHItem>& all_items = items;
+	std::nth_element(indices.begin() + start, indices.begin() + mid, indices.begin() + start + count,
+		[&all_items, axis](int a, int b) { return all_items[a].world_bounding.center.v[axis] < all_items[b].world_bounding.center.v[axis]; });
+
+	//careful, node reference is invalid after the recursion
+	int left = buildNode(start, mid - start, index);
+	int right = buildNode(mid, start + count - mid, index);
+	nodes[index].left = left;
+	nodes[index].right = right;
+	return index;
+}
+
+void SceneBVH::update(Scene* scene)
+{
+	if (entities.size() != scene->entities.size())
+	{
+		build(scene);
+		return;
+	}
+
+	dirty_nodes.clear();
+
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		sEntityInfo& info = entities[i];
+
+		Prefab* prefab = ent->entity_type == PREFAB ? ((GTR::PrefabEntity*)ent)->prefab : NULL;
+		//nodes edited inside the prefab also require a rebuild
+		if (prefab != info.prefab || (prefab && prefab->compiled.version != info.prefab_version))
+		{
+			build(scene);
+			return;
+		}
+
+		if (memcmp(info.model.m, ent->model.m, sizeof(Matrix44)) == 0)
+			continue;
+
+		info.model = ent->model;
+		refitEntity(scene, i);
+	}
+
+	if (!dirty_nodes.size())
+		return;
+
+	//parents are always created before their children, so refit from the highest index to the lowest
+	std::sort(dirty_nodes.begin(), dirty_nodes.end());
+	dirty_nodes.erase(std::unique(dirty_nodes.begin(), dirty_nodes.end()), dirty_nodes.end());
+	for (int i = (int)dirty_nodes.size() - 1; i >= 0; --i)
+		refitNode(dirty_nodes[i]);
+	dirty_nodes.clear();
+}
+
+void SceneBVH::refitEntity(Scene* scene, int entity_index)
+{
+	sEntityInfo& info = entities[entity_index];
+
+	for (int i = info.first_item; i < info.first_item + info.num_items; ++i)
+	{
+		sBVHItem& item = items[i];
+		item.model = item.node_model * info.model;
+		item.world_bounding = transformBoundingBox(item.model, item.mesh->box);
+
+		//mark the leaf and all its parents
+		for (int n = item.leaf; n != -1; n = nodes[n].parent)
+			dirty_nodes.push_back(n);
+	}
+}
+
+void SceneBVH::refitNode(int node_index)
+{
+	sBVHNode& node = nodes[node_index];
+	if (node.left == -1)
+		node.bounding = computeItemsBounding(items, &indices[node.start], node.count);
+	else
+		node.bounding = mergeBoundingBoxes(nodes[node.left].bounding, nodes[node.right].bounding);
+}
+
+void SceneBVH::cull(Camera* camera, Scene* scene, std::vector<int>& visible)
+{
+	visible.clear();
+	num_tested = 0;
+	num_visible = 0;
+	num_accepted = 0;
+
+	if (!nodes.size())
+		return;
+
+	cullSubtree(0, camera, scene, scratch);
+	visible.swap(scratch.visible);
+	num_tested = scratch.num_tested;
+	num_accepted = scratch.num_accepted;
+	num_visible = visible.size();
+}
+
+void SceneBVH::getSubtrees(int count, std::vector<int>& roots) const
+{
+	roots.clear();
+	if (!nodes.size())
+		return;
+
+	//splits the biggest subtree until there are enough, a node replaced by its children keeps the tree order
+	roots.push_back(0);
+	while (roots.size() < count)
+	{
+		int biggest = -1;
+		for (int i = 0; i < roots.size(); ++i)
+			if (nodes[roots[i]].left != -1 && (biggest == -1 || nodes[roots[i]].count > nodes[roots[biggest]].count))
+				biggest = i;
+		if (biggest == -1)
+			break;
+		const sBVHNode& node = nodes[roots[biggest]];
+		roots[biggest] = node.left;
+		roots.insert(roots.begin() + biggest + 1, node.right);
+	}
+}
+
+void SceneBVH::cullSubtree(int root, Camera* camera, Scene* scene, sCullScratch& scratch) const
+{
+	scratch.visible.clear();
+	scratch.num_tested = 0;
+	scratch.num_accepted = 0;
+
+	std::vector<int>& stack = scratch.stack;
+	std::vector<int>& candidates = scratch.candidates;
+	std::vector<int>& visible = scratch.visible;
+
+	stack.clear();
+	stack.push_back(root);
+	candidates.clear();
+	scratch.candidate_boxes.clear();
+
+	while (stack.size())
+	{
+		const sBVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		scratch.num_tested++;
+		char clip = camera->testBoxInFrustum(node.bounding.center, node.bounding.halfsize);
+		if (clip == CLIP_OUTSIDE)
+			continue;
+
+		//the whole subtree is inside, no need to test anything else
+		if (clip == CLIP_INSIDE)
+		{
+			for (int i = node.start; i < node.start + node.count; ++i)
+				if (scene->entities[items[indices[i]].entity_index]->visible)
+					visible.push_back(indices[i]);
+			scratch.num_accepted += node.count;
+			continue;
+		}
+
+		if (node.left != -1)
+		{
+			stack.push_back(node.right);
+			stack.push_back(node.left);
+			continue;
+		}
+
+		//leaf partially inside, its items are tested all together at the end
+		for (int i = node.start; i < node.start + node.count; ++i)
+		{
+			const sBVHItem& item = items[indices[i]];
+			if (!scene->entities[item.entity_index]->visible)
+				continue;
+			candidates.push_back(indices[i]);
+			scratch.candidate_boxes.add(item.world_bounding);
+		}
+	}
+
+	if (candidates.size())
+	{
+		scratch.candidate_mask.resize(candidates.size());
+		camera->testBoxesInFrustum(scratch.candidate_boxes, &scratch.candidate_mask[0]);
+		for (int i = 0; i < candidates.size(); ++i)
+			if (scratch.candidate_mask[i])
+				visible.push_back(candidates[i]);
+		scratch.num_tested += candidates.size();
+	}
+}
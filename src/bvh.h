@@ -0,0 +1,106 @@
+#pragma once
+
+#include "framework.h"
+#include "culling.h"
+#include <vector>
+
+//forward declarations
+class Camera;
+class Mesh;
+
+namespace GTR {
+
+	class Scene;
+	class Material;
+	class Prefab;
+	class CompiledPrefab;
+
+	//one mesh node of a prefab entity already placed in world space
+	struct sBVHItem {
+		Matrix44 node_model;		//node matrix relative to the prefab
+		Matrix44 model;				//node global matrix multiplied by the entity model
+		BoundingBox world_bounding;	//mesh bounding box in world space
+		Mesh* mesh;
+		Material* material;
+		int entity_index;			//index of the owner in scene->entities
+		int leaf;					//leaf of the tree that contains this item
+	};
+
+	//node of the tree, the items of any subtree are contiguous in SceneBVH::indices
+	struct sBVHNode {
+		BoundingBox bounding;
+		int parent;
+		int left;	//-1 if it is a leaf
+		int right;
+		int start;	//first item in SceneBVH::indices
+		int count;	//number of items in the whole subtree
+	};
+
+	//bounding volume hierarchy over all the prefab nodes of the scene
+	//used to accept or reject whole groups of nodes when culling against a frustum
+	class SceneBVH {
+	public:
+		static const int MAX_LEAF_ITEMS = 4;
+
+		std::vector<sBVHItem> items;	//sorted by entity
+		std::vector<int> indices;		//items in tree order
+		std::vector<sBVHNode> nodes;	//nodes[0] is the root
+
+		//per entity info to detect changes
+		struct sEntityInfo {
+			Matrix44 model;
+			Prefab* prefab;
+			int prefab_version;
+			int first_item;
+			int num_items;
+		};
+		std::vector<sEntityInfo> entities;
+
+		std::vector<int> dirty_nodes;
+
+		//buffers of one traversal, every thread culling a subtree needs its own
+		struct sCullScratch {
+			std::vector<int> stack;
+			//items of the partially visible leaves, tested in one batch
+			std::vector<int> candidates;
+			BoxArraySoA candidate_boxes;
+			std::vector<unsigned char> candidate_mask;
+			std::vector<int> visible;	//output of cullSubtree
+			int num_tested;
+			int num_accepted;
+		};
+		sCullScratch scratch;
+
+		//stats of the last cull
+		int num_tested;
+		int num_visible;
+		int num_accepted;	//items of the nodes completely inside the frustum, not tested one by one
+
+		SceneBVH();
+
+		void clear();
+
+		//builds the whole tree from the prefab entities of the scene
+		void build(Scene* scene);
+
+		//rebuilds or refits the tree if the entities changed since last call
+		void update(Scene* scene);
+
+		//refits the nodes that contain the items of one entity
+		void refitEntity(Scene* scene, int entity_index);
+
+		//fills visible with the index of the items inside the frustum
+		void cull(Camera* camera, Scene* scene, std::vector<int>& visible);
+
+		//at least count nodes (if the tree is big enough) whose subtrees cover the whole tree, in tree order
+		void getSubtrees(int count, std::vector<int>& roots) const;
+		//culls the subtree of a node into scratch.visible, it only reads the tree so it can run in several threads
+		void cullSubtree(int root, Camera* camera, Scene* scene, sCullScratch& scratch) const;
+
+	private:
+		void addPrefabItems(const Matrix44& prefab_model, CompiledPrefab* compiled, int entity_index);
+		int buildNode(int start, int count, int parent);
+		void refitNode(int node_index);
+	};
+
+};
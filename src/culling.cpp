@@ -0,0 +1,310 @@
+#include "culling.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define CULLING_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define TARGET_SSE
+		#define TARGET_AVX2
+	#else
+		//gcc and clang need the instruction set enabled per function
+		#define TARGET_SSE __attribute__((target("sse")))
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+void BoxArraySoA::clear()
+{
+	cx.clear(); cy.clear(); cz.clear();
+	hx.clear(); hy.clear(); hz.clear();
+}
+
+void BoxArraySoA::reserve(int num)
+{
+	cx.reserve(num); cy.reserve(num); cz.reserve(num);
+	hx.reserve(num); hy.reserve(num); hz.reserve(num);
+}
+
+void BoxArraySoA::add(const Vector3& center, const Vector3& halfsize)
+{
+	cx.push_back(center.x); cy.push_back(center.y); cz.push_back(center.z);
+	hx.push_back(halfsize.x); hy.push_back(halfsize.y); hz.push_back(halfsize.z);
+}
+
+//same test as planeBoxOverlap, a box is outside if it is behind any plane
+static int testBoxesScalar(const float frustum[6][4], const BoxArraySoA& boxes, unsigned char* mask, int start)
+{
+	int num_visible = 0;
+	for (int i = start; i < boxes.size(); ++i)
+	{
+		unsigned char visible = 1;
+		for (int p = 0; p < 6; ++p)
+		{
+			const float* plane = frustum[p];
+			float radius = fabs(boxes.hx[i] * plane[0]) + fabs(boxes.hy[i] * plane[1]) + fabs(boxes.hz[i] * plane[2]);
+			float distance = plane[0] * boxes.cx[i] + plane[1] * boxes.cy[i] + plane[2] * boxes.cz[i] + plane[3];
+			if (distance <= -radius)
+			{
+				visible = 0;
+				break;
+			}
+		}
+		mask[i] = visible;
+		num_visible += visible;
+	}
+	return num_visible;
+}
+
+//squared distance from the center to the closest point of the box against the squared radius
+static int testSphereBoxesScalar(const Vector3& center, float radius, const BoxArraySoA& boxes, int start, int count, unsigned char* mask, int first)
+{
+	int num_touched = 0;
+	float radius2 = radius * radius;
+	for (int i = first; i < count; ++i)
+	{
+		int b = start + i;
+		float dx = std::max(std::fabs(center.x - boxes.cx[b]) - boxes.hx[b], 0.0f);
+		float dy = std::max(std::fabs(center.y - boxes.cy[b]) - boxes.hy[b], 0.0f);
+		float dz = std::max(std::fabs(center.z - boxes.cz[b]) - boxes.hz[b], 0.0f);
+		mask[i] = dx * dx + dy * dy + dz * dz <= radius2;
+		num_touched += mask[i];
+	}
+	return num_touched;
+}
+
+#ifdef CULLING_X86
+
+TARGET_SSE static int testBoxesSSE(const float frustum[6][4], const BoxArraySoA& boxes, unsigned char* mask)
+{
+	//planes and absolute value of the normals splatted in registers
+	__m128 planes[6][4];
+	__m128 abs_normals[6][3];
+	for (int p = 0; p < 6; ++p)
+		for (int j = 0; j < 4; ++j)
+		{
+			planes[p][j] = _mm_set1_ps(frustum[p][j]);
+			if (j < 3)
+				abs_normals[p][j] = _mm_set1_ps(fabs(frustum[p][j]));
+		}
+
+	const __m128 zero = _mm_setzero_ps();
+	int num_visible = 0;
+	int count = boxes.size();
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&boxes.cx[i]);
+		__m128 cy = _mm_loadu_ps(&boxes.cy[i]);
+		__m128 cz = _mm_loadu_ps(&boxes.cz[i]);
+		__m128 hx = _mm_loadu_ps(&boxes.hx[i]);
+		__m128 hy = _mm_loadu_ps(&boxes.hy[i]);
+		__m128 hz = _mm_loadu_ps(&boxes.hz[i]);
+
+		//distance + radius must be positive for every plane
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+		for (int p = 0; p < 6; ++p)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], cx), _mm_mul_ps(planes[p][1], cy)),
+				_mm_add_ps(_mm_mul_ps(planes[p][2], cz), planes[p][3]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_normals[p][0], hx), _mm_mul_ps(abs_normals[p][1], hy)),
+				_mm_mul_ps(abs_normals[p][2], hz));
+			inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int bits = _mm_movemask_ps(inside);
+		for (int j = 0; j < 4; ++j)
+		{
+			mask[i + j] = (bits >> j) & 1;
+			num_visible += mask[i + j];
+		}
+	}
+
+	return num_visible + testBoxesScalar(frustum, boxes, mask, i);
+}
+
+TARGET_AVX2 static int testBoxesAVX2(const float frustum[6][4], const BoxArraySoA& boxes, unsigned char* mask)
+{
+	__m256 planes[6][4];
+	__m256 abs_normals[6][3];
+	for (int p = 0; p < 6; ++p)
+		for (int j = 0; j < 4; ++j)
+		{
+			planes[p][j] = _mm256_set1_ps(frustum[p][j]);
+			if (j < 3)
+				abs_normals[p][j] = _mm256_set1_ps(fabs(frustum[p][j]));
+		}
+
+	const __m256 zero = _mm256_setzero_ps();
+	int num_visible = 0;
+	int count = boxes.size();
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(&boxes.cx[i]);
+		__m256 cy = _mm256_loadu_ps(&boxes.cy[i]);
+		__m256 cz = _mm256_loadu_ps(&boxes.cz[i]);
+		__m256 hx = _mm256_loadu_ps(&boxes.hx[i]);
+		__m256 hy = _mm256_loadu_ps(&boxes.hy[i]);
+		__m256 hz = _mm256_loadu_ps(&boxes.hz[i]);
+
+		__m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+		for (int p = 0; p < 6; ++p)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes[p][0], cx), _mm256_mul_ps(planes[p][1], cy)),
+				_mm256_add_ps(_mm256_mul_ps(planes[p][2], cz), planes[p][3]));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(abs_normals[p][0], hx), _mm256_mul_ps(abs_normals[p][1], hy)),
+				_mm256_mul_ps(abs_normals[p][2], hz));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GT_OQ));
+		}
+
+		int bits = _mm256_movemask_ps(inside);
+		for (int j = 0; j < 8; ++j)
+		{
+			mask[i + j] = (bits >> j) & 1;
+			num_visible += mask[i + j];
+		}
+	}
+
+	return num_visible + testBoxesScalar(frustum, boxes, mask, i);
+}
+
+TARGET_SSE static int testSphereBoxesSSE(const Vector3& center, float radius, const BoxArraySoA& boxes, int start, int count, unsigned char* mask)
+{
+	const __m128 sx = _mm_set1_ps(center.x);
+	const __m128 sy = _mm_set1_ps(center.y);
+	const __m128 sz = _mm_set1_ps(center.z);
+	const __m128 radius2 = _mm_set1_ps(radius * radius);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	int num_touched = 0;
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		int b = start + i;
+		__m128 dx = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign, _mm_sub_ps(sx, _mm_loadu_ps(&boxes.cx[b]))), _mm_loadu_ps(&boxes.hx[b])), zero);
+		__m128 dy = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign, _mm_sub_ps(sy, _mm_loadu_ps(&boxes.cy[b]))), _mm_loadu_ps(&boxes.hy[b])), zero);
+		__m128 dz = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign, _mm_sub_ps(sz, _mm_loadu_ps(&boxes.cz[b]))), _mm_loadu_ps(&boxes.hz[b])), zero);
+		__m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+		int bits = _mm_movemask_ps(_mm_cmple_ps(distance2, radius2));
+		for (int j = 0; j < 4; ++j)
+		{
+			mask[i + j] = (bits >> j) & 1;
+			num_touched += mask[i + j];
+		}
+	}
+
+	return num_touched + testSphereBoxesScalar(center, radius, boxes, start, count, mask, i);
+}
+
+TARGET_AVX2 static int testSphereBoxesAVX2(const Vector3& center, float radius, const BoxArraySoA& boxes, int start, int count, unsigned char* mask)
+{
+	const __m256 sx = _mm256_set1_ps(center.x);
+	const __m256 sy = _mm256_set1_ps(center.y);
+	const __m256 sz = _mm256_set1_ps(center.z);
+	const __m256 radius2 = _mm256_set1_ps(radius * radius);
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+	const __m256 zero = _mm256_setzero_ps();
+
+	int num_touched = 0;
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		int b = start + i;
+		__m256 dx = _mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(sx, _mm256_loadu_ps(&boxes.cx[b]))), _mm256_loadu_ps(&boxes.hx[b])), zero);
+		__m256 dy = _mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(sy, _mm256_loadu_ps(&boxes.cy[b]))), _mm256_loadu_ps(&boxes.hy[b])), zero);
+		__m256 dz = _mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(sz, _mm256_loadu_ps(&boxes.cz[b]))), _mm256_loadu_ps(&boxes.hz[b])), zero);
+		__m256 distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+		int bits = _mm256_movemask_ps(_mm256_cmp_ps(distance2, radius2, _CMP_LE_OQ));
+		for (int j = 0; j < 8; ++j)
+		{
+			mask[i + j] = (bits >> j) & 1;
+			num_touched += mask[i + j];
+		}
+	}
+
+	return num_touched + testSphereBoxesScalar(center, radius, boxes, start, count, mask, i);
+}
+
+static bool cpuSupportsAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	//the os must save the ymm registers too
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif
+
+static eSIMDLevel detectSIMDLevel()
+{
+#ifdef CULLING_X86
+	return cpuSupportsAVX2() ? SIMD_AVX2 : SIMD_SSE;
+#else
+	return SIMD_SCALAR;
+#endif
+}
+
+eSIMDLevel getSIMDLevel()
+{
+	//static initialization is thread safe, it can be called from the workers
+	static const eSIMDLevel level = detectSIMDLevel();
+	return level;
+}
+
+const char* getSIMDLevelName(eSIMDLevel level)
+{
+	switch (level)
+	{
+		case SIMD_SSE: return "SSE";
+		case SIMD_AVX2: return "AVX2";
+		default: return "scalar";
+	}
+}
+
+int testBoxesInFrustum(const float frustum[6][4], const BoxArraySoA& boxes, unsigned char* mask, eSIMDLevel level)
+{
+	//never use an instruction set the cpu does not have
+	if (level > getSIMDLevel())
+		level = getSIMDLevel();
+
+#ifdef CULLING_X86
+	if (level == SIMD_AVX2)
+		return testBoxesAVX2(frustum, boxes, mask);
+	if (level == SIMD_SSE)
+		return testBoxesSSE(frustum, boxes, mask);
+#endif
+	return testBoxesScalar(frustum, boxes, mask, 0);
+}
+
+int testSphereBoxes(const Vector3& center, float radius, const BoxArraySoA& boxes, int start, int count, unsigned char* mask, eSIMDLevel level)
+{
+	if (level > getSIMDLevel())
+		level = getSIMDLevel();
+
+#ifdef CULLING_X86
+	if (level == SIMD_AVX2)
+		return testSphereBoxesAVX2(center, radius, boxes, start, count, mask);
+	if (level == SIMD_SSE)
+		return testSphereBoxesSSE(center, radius, boxes, start, count, mask);
+#endif
+	return testSphereBoxesScalar(center, radius, boxes, start, count, mask, 0);
+}
@@ -0,0 +1,41 @@
+/*  batched frustum culling
+	Tests several bounding boxes at once using SSE (4 boxes) or AVX2 (8 boxes) when the cpu supports it.
+	The same batches are used to find the boxes touched by a sphere (lights against clusters).
+	The boxes are stored in SoA layout (one array per component) so they can be loaded directly in SIMD registers.
+*/
+
+#pragma once
+
+#include "framework.h"
+#include <vector>
+
+//list of boxes with one array per component
+struct BoxArraySoA {
+	std::vector<float> cx, cy, cz;	//centers
+	std::vector<float> hx, hy, hz;	//halfsizes
+
+	void clear();
+	void reserve(int num);
+	void add(const Vector3& center, const Vector3& halfsize);
+	void add(const BoundingBox& box) { add(box.center, box.halfsize); }
+	int size() const { return (int)cx.size(); }
+};
+
+//instruction sets available for the batch test
+enum eSIMDLevel {
+	SIMD_SCALAR = 0,
+	SIMD_SSE,
+	SIMD_AVX2
+};
+
+//best instruction set supported by this cpu (detected the first time)
+eSIMDLevel getSIMDLevel();
+const char* getSIMDLevelName(eSIMDLevel level);
+
+//writes 1 in mask for every box inside or overlapping the frustum and 0 for the ones completely outside
+//mask must have room for boxes.size() elements, returns the number of boxes not culled
+int testBoxesInFrustum(const float frustum[6][4], const BoxArraySoA& boxes, unsigned char* mask, eSIMDLevel level);
+
+//writes in mask[i] 1 if the box start + i touches the sphere and 0 otherwise, for count boxes
+//returns the number of boxes touched
+int testSphereBoxes(const Vector3& center, float radius, const BoxArraySoA& boxes, int start, int count, unsigned char* mask, eSIMDLevel level);
@@ -0,0 +1,358 @@
+#include "decals.h"
+
+#include "camera.h"
+#include "glstate.h"
+#include "mesh.h"
+#include "scene.h"
+#include "shader.h"
+#include "texture.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+using namespace GTR;
+
+//the decal projects its albedo inside the cube from -1 to 1 of its model
+static const BoundingBox decal_box(Vector3(0, 0, 0), Vector3(1, 1, 1));
+
+//merges the boxes of a range of items
+static BoundingBox computeItemsBounding(const std::vector<sDecalItem>& items, const int* indices, int count)
+{
+	Vector3 bbmin(1e20f, 1e20f, 1e20f);
+	Vector3 bbmax(-1e20f, -1e20f, -1e20f);
+	for (int i = 0; i < count; ++i)
+	{
+		const BoundingBox& box = items[indices[i]].world_bounding;
+		bbmin.setMin(box.center - box.halfsize);
+		bbmax.setMax(box.center + box.halfsize);
+	}
+	Vector3 halfsize = (bbmax - bbmin) * 0.5;
+	return BoundingBox(bbmin + halfsize, halfsize);
+}
+
+DecalRenderer::DecalRenderer()
+{
+	albedos = NULL;
+	num_tested = 0;
+	num_accepted = 0;
+	vao = 0;
+	vertices_vbo = 0;
+	instances_vbo = 0;
+	layers_fbo = 0;
+}
+
+DecalRenderer::~DecalRenderer()
+{
+	delete albedos;
+	if (vao)
+	{
+		GLState::forgetVertexArray(vao);
+		glDeleteVertexArrays(1, &vao);
+		glDeleteBuffers(1, &vertices_vbo);
+		glDeleteBuffers(1, &instances_vbo);
+	}
+	if (layers_fbo)
+		glDeleteFramebuffers(1, &layers_fbo);
+}
+
+void DecalRenderer::update(Scene* scene)
+{
+	//decals rarely move, any change rebuilds the whole tree
+	int num_decals = 0;
+	bool changed = false;
+	for (int i = 0; i < scene->entities.size() && !changed; ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (ent->entity_type != DECAL || !((DecalEntity*)ent)->albedo)
+			continue;
+		if (num_decals >= infos.size())
+		{
+			changed = true;
+			break;
+		}
+		const sDecalInfo& info = infos[num_decals++];
+		changed = info.entity_index != i || info.albedo != ((DecalEntity*)ent)->albedo || memcmp(info.model.m, ent->model.m, sizeof(Matrix44)) != 0;
+	}
+
+	if (changed || num_decals != infos.size())
+		build(scene);
+}
+
+void DecalRenderer::build(Scene* scene)
+{
+	items.clear();
+	infos.clear();
+
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (ent->entity_type != DECAL)
+			continue;
+		DecalEntity* dent = (DecalEntity*)ent;
+		if (!dent->albedo)
+			continue;
+
+		sDecalInfo info;
+		info.entity_index = i;
+		info.model = ent->model;
+		info.albedo = dent->albedo;
+		infos.push_back(info);
+
+		sDecalItem item;
+		item.entity_index = i;
+		item.world_bounding = transformBoundingBox(ent->model, decal_box);
+		item.instance.model = ent->model;
+		item.instance.inverse_model = ent->model;
+		item.instance.inverse_model.inverse();
+		item.instance.layer = (float)addLayer(dent->albedo);
+		item.instance.padding[0] = item.instance.padding[1] = item.instance.padding[2] = 0;
+		items.push_back(item);
+	}
+
+	indices.resize(items.size());
+	for (int i = 0; i < indices.size(); ++i)
+		indices[i] = i;
+
+	nodes.clear();
+	if (items.size())
+		buildNode(0, items.size());
+}
+
+//top-down build splitting by the median of the largest axis, like SceneBVH
+int DecalRenderer::buildNode(int start, int count)
+{
+	int index = nodes.size();
+	nodes.push_back(sDecalNode());
+
+	sDecalNode& node = nodes[index];
+	node.left = node.right = -1;
+	node.start = start;
+	node.count = count;
+	node.bounding = computeItemsBounding(items, &indices[start], count);
+
+	if (count <= MAX_LEAF_ITEMS)
+		return index;
+
+	Vector3 cmin(1e20f, 1e20f, 1e20f);
+	Vector3 cmax(-1e20f, -1e20f, -1e20f);
+	for (int i = start; i < start + count; ++i)
+	{
+		cmin.setMin(items[indices[i]].world_bounding.center);
+		cmax.setMax(items[indices[i]].world_bounding.center);
+	}
+	Vector3 extent = cmax - cmin;
+	int axis = 0;
+	if (extent.y > extent.x) axis = 1;
+	if (extent.z > extent.v[axis]) axis = 2;
+
+	int mid = start + count / 2;
+	const std::vector<sDecalItem>& all_items = items;
+	std::nth_element(indices.begin() + start, indices.begin() + mid, indices.begin() + start + count,
+		[&all_items, axis](int a, int b) { return all_items[a].world_bounding.center.v[axis] < all_items[b].world_bounding.center.v[axis]; });
+
+	//careful, node reference is invalid after the recursion
+	int left = buildNode(start, mid - start);
+	int right = buildNode(mid, start + count - mid);
+	nodes[index].left = left;
+	nodes[index].right = right;
+	return index;
+}
+
+void DecalRenderer::cull(Camera* camera, Scene* scene)
+{
+	instances.clear();
+	num_tested = 0;
+	num_accepted = 0;
+
+	if (!nodes.size())
+		return;
+
+	stack.clear();
+	stack.push_back(0);
+	candidates.clear();
+	candidate_boxes.clear();
+
+	while (stack.size())
+	{
+		const sDecalNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		num_tested++;
+		char clip = camera->testBoxInFrustum(node.bounding.center, node.bounding.halfsize);
+		if (clip == CLIP_OUTSIDE)
+			continue;
+
+		if (clip == CLIP_INSIDE)
+		{
+			for (int i = node.start; i < node.start + node.count; ++i)
+			{
+				const sDecalItem& item = items[indices[i]];
+				if (scene->entities[item.entity_index]->visible)
+					instances.push_back(item.instance);
+			}
+			num_accepted += node.count;
+			continue;
+		}
+
+		if (node.left != -1)
+		{
+			stack.push_back(node.right);
+			stack.push_back(node.left);
+			continue;
+		}
+
+		//leaf partially inside, its items are tested all together at the end
+		for (int i = node.start; i < node.start + node.count; ++i)
+		{
+			const sDecalItem& item = items[indices[i]];
+			if (!scene->entities[item.entity_index]->visible)
+				continue;
+			candidates.push_back(indices[i]);
+			candidate_boxes.add(item.world_bounding);
+		}
+	}
+
+	if (candidates.size())
+	{
+		candidate_mask.resize(candidates.size());
+		camera->testBoxesInFrustum(candidate_boxes, &candidate_mask[0]);
+		for (int i = 0; i < candidates.size(); ++i)
+			if (candidate_mask[i])
+				instances.push_back(items[candidates[i]].instance);
+		num_tested += candidates.size();
+	}
+}
+
+void DecalRenderer::render()
+{
+	if (!instances.size())
+		return;
+
+	if (!vao)
+		createBuffers();
+
+	//orphan the previous data so the driver does not wait for the last draw using it
+	glBindBuffer(GL_ARRAY_BUFFER, instances_vbo);
+	GLState::num_buffer_binds++;
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(sDecalInstance), NULL, GL_STREAM_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(sDecalInstance), &instances[0], GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//6 faces of 2 triangles
+	GLState::bindVertexArray(vao);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)instances.size());
+	GLState::num_draw_calls++;
+	GLState::bindVertexArray(0);
+}
+
+void DecalRenderer::createBuffers()
+{
+	Mesh cube;
+	cube.createCube();
+
+	glGenVertexArrays(1, &vao);
+	GLState::bindVertexArray(vao);
+
+	glGenBuffers(1, &vertices_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo);
+	glBufferData(GL_ARRAY_BUFFER, cube.vertices.size() * sizeof(Vector3), &cube.vertices[0], GL_STATIC_DRAW);
+	glEnableVertexAttribArray(ATTRIB_VERTEX);
+	glVertexAttribPointer(ATTRIB_VERTEX, 3, GL_FLOAT, GL_FALSE, sizeof(Vector3), (void*)0);
+
+	//mat4 count as 4 different attributes of vec4
+	glGenBuffers(1, &instances_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, instances_vbo);
+	for (int k = 0; k < 4; ++k)
+	{
+		glEnableVertexAttribArray(ATTRIB_INSTANCE_MODEL + k);
+		glVertexAttribPointer(ATTRIB_INSTANCE_MODEL + k, 4, GL_FLOAT, GL_FALSE, sizeof(sDecalInstance), (void*)(offsetof(sDecalInstance, model) + sizeof(float) * 4 * k));
+		glVertexAttribDivisor(ATTRIB_INSTANCE_MODEL + k, 1);
+		glEnableVertexAttribArray(ATTRIB_INSTANCE_INVERSE_MODEL + k);
+		glVertexAttribPointer(ATTRIB_INSTANCE_INVERSE_MODEL + k, 4, GL_FLOAT, GL_FALSE, sizeof(sDecalInstance), (void*)(offsetof(sDecalInstance, inverse_model) + sizeof(float) * 4 * k));
+		glVertexAttribDivisor(ATTRIB_INSTANCE_INVERSE_MODEL + k, 1);
+	}
+	glEnableVertexAttribArray(ATTRIB_INSTANCE_LAYER);
+	glVertexAttribPointer(ATTRIB_INSTANCE_LAYER, 1, GL_FLOAT, GL_FALSE, sizeof(sDecalInstance), (void*)offsetof(sDecalInstance, layer));
+	glVertexAttribDivisor(ATTRIB_INSTANCE_LAYER, 1);
+
+	GLState::bindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	checkGLErrors();
+}
+
+int DecalRenderer::addLayer(Texture* texture)
+{
+	std::map<Texture*, int>::iterator it = layer_index.find(texture);
+	if (it != layer_index.end())
+		return it->second;
+
+	int layer = layers.size();
+	layers.push_back(texture);
+	layer_index[texture] = layer;
+
+	//the array can not grow, a bigger one is created and all the layers are drawn again
+	if (!albedos || albedos->depth < layers.size())
+	{
+		createArray(std::max(4, (int)layers.size() * 2));
+		return layer;
+	}
+
+	drawLayer(layer);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, albedos->texture_id);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	return layer;
+}
+
+void DecalRenderer::createArray(int capacity)
+{
+	delete albedos;
+	albedos = new Texture();
+	albedos->width = albedos->height = DECAL_LAYER_SIZE;
+	albedos->depth = capacity;
+	albedos->format = GL_RGBA;
+	albedos->type = GL_UNSIGNED_BYTE;
+	albedos->internal_format = GL_RGBA8;
+	albedos->texture_type = GL_TEXTURE_2D_ARRAY;
+	albedos->mipmaps = true;
+
+	glGenTextures(1, &albedos->texture_id);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, albedos->texture_id);
+	for (int level = 0, size = DECAL_LAYER_SIZE; size > 0; ++level, size /= 2)
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size, size, capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	for (int i = 0; i < layers.size(); ++i)
+		drawLayer(i);
+
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, albedos->texture_id);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	checkGLErrors();
+}
+
+//the textures have any size and their pixels are only in VRAM, so they are resampled with a quad
+void DecalRenderer::drawLayer(int layer)
+{
+	GLint previous_fbo = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_fbo);
+
+	if (!layers_fbo)
+		glGenFramebuffers(1, &layers_fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, layers_fbo);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedos->texture_id, 0, layer);
+
+	glPushAttrib(GL_VIEWPORT_BIT);
+	glViewport(0, 0, DECAL_LAYER_SIZE, DECAL_LAYER_SIZE);
+	GLState::disable(GL_BLEND);
+	layers[layer]->toViewport();
+	glPopAttrib();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "framework.h"
+#include "culling.h"
+#include <vector>
+#include <map>
+
+//forward declarations
+class Camera;
+class Texture;
+
+namespace GTR {
+
+	class Scene;
+
+	//side of every layer of the albedo array, the decal textures are resampled to it
+	const int DECAL_LAYER_SIZE = 512;
+
+	//per instance data of the decal draw, read by decalls.vs
+	struct sDecalInstance {
+		Matrix44 model;			//places the cube of the decal
+		Matrix44 inverse_model;	//world to decal space, to project the albedo
+		float layer;			//layer of the albedo array
+		float padding[3];
+	};
+
+	//one decal entity placed in world space
+	struct sDecalItem {
+		BoundingBox world_bounding;
+		int entity_index;		//index of the owner in scene->entities
+		sDecalInstance instance;
+	};
+
+	//node of the tree, the items of any subtree are contiguous in DecalRenderer::indices
+	struct sDecalNode {
+		BoundingBox bounding;
+		int left;	//-1 if it is a leaf
+		int right;
+		int start;	//first item in DecalRenderer::indices
+		int count;	//number of items in the whole subtree
+	};
+
+	//all the decals of the scene drawn in one instanced call
+	//they are kept in a bounding volume hierarchy to cull them against the frustum
+	//and their albedos are packed in a texture array so every instance only needs a layer
+	class DecalRenderer {
+	public:
+		static const int MAX_LEAF_ITEMS = 8;
+
+		std::vector<sDecalItem> items;
+		std::vector<int> indices;		//items in tree order
+		std::vector<sDecalNode> nodes;	//nodes[0] is the root
+
+		Texture* albedos;					//GL_TEXTURE_2D_ARRAY, NULL until there is a decal
+		std::vector<Texture*> layers;		//texture resampled in every layer
+		std::map<Texture*, int> layer_index;
+
+		//visible decals after the last cull
+		std::vector<sDecalInstance> instances;
+
+		//stats of the last cull
+		int num_tested;
+		int num_accepted;	//decals of the nodes completely inside the frustum, not tested one by one
+
+		DecalRenderer();
+		~DecalRenderer();
+
+		//rebuilds the tree if the decals of the scene changed and adds the new albedos to the array
+		void update(Scene* scene);
+
+		//fills instances with the decals inside the frustum
+		void cull(Camera* camera, Scene* scene);
+
+		//draws the cube of every visible decal with the shader in use
+		void render();
+
+	private:
+		//model and albedo of every decal when the tree was built, to detect changes
+		struct sDecalInfo {
+			int entity_index;
+			Matrix44 model;
+			Texture* albedo;
+		};
+		std::vector<sDecalInfo> infos;
+
+		std::vector<int> stack;
+		std::vector<int> candidates;
+		BoxArraySoA candidate_boxes;
+		std::vector<unsigned char> candidate_mask;
+
+		unsigned int vao;
+		unsigned int vertices_vbo;
+		unsigned int instances_vbo;
+		unsigned int layers_fbo;
+
+		void build(Scene* scene);
+		int buildNode(int start, int count);
+
+		int addLayer(Texture* texture);
+		//allocates the array with room for capacity layers and resamples the textures again
+		void createArray(int capacity);
+		void drawLayer(int layer);
+
+		void createBuffers();
+	};
+
+};
@@ -1,41 +1,41 @@
-/*   ColDet - C++ 3D Collision Detection Library
- *   Copyright (C) 2000   Amir Geva
- * 
- * This library is free software; you can redistribute it and/or
- * modify it under the terms of the GNU Library General Public
- * License as published by the Free Software Foundation; either
- * version 2 of the License, or (at your option) any later version.
- * 
- * This library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
- * Library General Public License for more details.
- * 
- * You should have received a copy of the GNU Library General Public
- * License along with this library; if not, write to the
- * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
- * Boston, MA  02111-1307, USA.
- *
- * Any comments, questions and bug reports send to:
- *   photon@photoneffect.com
- *
- * Or visit the home page: http://photoneffect.com/coldet/
- */
-#include "sysdep.h"
-
-#ifdef GCC
-
-#include <sys/time.h>
-
-// Returns a time index in milliseconds
-DWORD GetTickCount()
-{
-  static struct timezone tz={0,0};
-  static const double t1=1000.0;
-  static const double t2=0.001;
-  timeval t;
-  gettimeofday(&t,&tz);
-  return long((t.tv_sec&0x000FFFFF)*t1 + t.tv_usec*t2);
-}
-
-#endif
+/*   ColDet - C++ 3D Collision Detection Library
+ *   Copyright (C) 2000   Amir Geva
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA  02111-1307, USA.
+ *
+ * Any comments, questions and bug reports send to:
+ *   photon@photoneffect.com
+ *
+ * Or visit the home page: http://photoneffect.com/coldet/
+ */
+#include "sysdep.h"
+
+#ifdef GCC
+
+#include <sys/time.h>
+
+// Returns a time index in milliseconds
+DWORD GetTickCount()
+{
+  static struct timezone tz={0,0};
+  static const double t1=1000.0;
+  static const double t2=0.001;
+  timeval t;
+  gettimeofday(&t,&tz);
+  return long((t.tv_sec&0x000FFFFF)*t1 + t.tv_usec*t2);
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "framegraph.h"
+
+#include "texture.h"
+
+using namespace GTR;
+
+//pool textures not used for this number of frames are released, after a resize or a change of the effects
+const int MAX_UNUSED_FRAMES = 60;
+
+size_t GTR::getTargetBytes(const sTargetDesc& desc)
+{
+	if (desc.internal_format)
+		return (size_t)desc.width * desc.height * Texture::getBytesPerPixel(desc.internal_format);
+
+	int channels = 4;
+	switch (desc.format)
+	{
+		case GL_RED: case GL_DEPTH_COMPONENT: channels = 1; break;
+		case GL_RG: channels = 2; break;
+		case GL_RGB: channels = 3; break;
+	}
+	int channel_bytes = 1;
+	switch (desc.type)
+	{
+		case GL_FLOAT: case GL_UNSIGNED_INT: case GL_INT: channel_bytes = 4; break;
+		case GL_HALF_FLOAT: case GL_UNSIGNED_SHORT: case GL_SHORT: channel_bytes = 2; break;
+	}
+	return (size_t)desc.width * desc.height * channels * channel_bytes;
+}
+
+FrameGraph::FrameGraph()
+{
+	num_culled = 0;
+	memory = 0;
+	memory_no_aliasing = 0;
+}
+
+FrameGraph::~FrameGraph()
+{
+	for (int i = 0; i < pool.size(); ++i)
+		delete pool[i].texture;
+}
+
+void FrameGraph::clear()
+{
+	resources.clear();
+	passes.clear();
+}
+
+int FrameGraph::importTexture(const char* name, Texture* texture, bool output)
+{
+	sResource resource;
+	resource.name = name;
+	resource.desc = sTargetDesc();
+	if (texture)
+	{
+		resource.desc.width = texture->width;
+		resource.desc.height = texture->height;
+		resource.desc.format = texture->format;
+		resource.desc.type = texture->type;
+		resource.desc.internal_format = texture->internal_format;
+	}
+	resource.texture = texture;
+	resource.imported = true;
+	resource.needed = output;
+	resources.push_back(resource);
+	return resources.size() - 1;
+}
+
+int FrameGraph::createTarget(const char* name, const sTargetDesc& desc)
+{
+	sResource resource;
+	resource.name = name;
+	resource.desc = desc;
+	resource.texture = NULL;
+	resource.imported = false;
+	resource.needed = false;
+	resources.push_back(resource);
+	return resources.size() - 1;
+}
+
+int FrameGraph::addPass(const char* name, const std::vector<int>& inputs, const std::vector<int>& outputs, std::function<void(FrameGraph&)> execute)
+{
+	sPass pass;
+	pass.name = name;
+	pass.inputs = inputs;
+	pass.outputs = outputs;
+	pass.execute = execute;
+	pass.culled = false;
+	passes.push_back(pass);
+	return passes.size() - 1;
+}
+
+void FrameGraph::compile()
+{
+	//from the last pass to the first, a pass is kept if something needed reads what it writes
+	num_culled = 0;
+	for (int i = (int)passes.size() - 1; i >= 0; --i)
+	{
+		sPass& pass = passes[i];
+		pass.culled = true;
+		for (int j = 0; j < pass.outputs.size(); ++j)
+			if (resources[pass.outputs[j]].needed)
+				pass.culled = false;
+		if (pass.culled)
+		{
+			num_culled++;
+			continue;
+		}
+		for (int j = 0; j < pass.inputs.size(); ++j)
+			resources[pass.inputs[j]].needed = true;
+	}
+
+	//lifetime of every target in the passes that remain
+	for (int i = 0; i < resources.size(); ++i)
+		resources[i].first_pass = resources[i].last_pass = -1;
+	for (int i = 0; i < passes.size(); ++i)
+	{
+		sPass& pass = passes[i];
+		if (pass.culled)
+			continue;
+		for (int k = 0; k < 2; ++k)
+		{
+			std::vector<int>& list = k ? pass.outputs : pass.inputs;
+			for (int j = 0; j < list.size(); ++j)
+			{
+				sResource& resource = resources[list[j]];
+				if (resource.first_pass == -1)
+					resource.first_pass = i;
+				resource.last_pass = i;
+			}
+		}
+	}
+
+	//a target takes a pool texture of the same description that no living target is using
+	for (int i = 0; i < pool.size(); ++i)
+		pool[i].free_from = 0;
+	std::vector<char> used(pool.size(), 0);
+	memory_no_aliasing = 0;
+	for (int i = 0; i < passes.size(); ++i)
+	{
+		if (passes[i].culled)
+			continue;
+		for (int j = 0; j < passes[i].outputs.size(); ++j)
+		{
+			sResource& resource = resources[passes[i].outputs[j]];
+			if (resource.imported || resource.first_pass != i)
+				continue;
+			memory_no_aliasing += getTargetBytes(resource.desc);
+
+			int index = -1;
+			for (int k = 0; k < pool.size() && index == -1; ++k)
+				if (pool[k].free_from <= i && pool[k].desc == resource.desc)
+					index = k;
+			if (index == -1)
+			{
+				sPooledTexture pooled;
+				pooled.texture = new Texture(resource.desc.width, resource.desc.height, resource.desc.format, resource.desc.type, false, NULL, resource.desc.internal_format);
+				pooled.desc = resource.desc;
+				pooled.unused_frames = 0;
+				pool.push_back(pooled);
+				used.push_back(0);
+				index = pool.size() - 1;
+			}
+
+			//free again after the last pass that reads it, it is still bound while that pass runs
+			pool[index].free_from = resource.last_pass + 1;
+			used[index] = 1;
+			resource.texture = pool[index].texture;
+		}
+	}
+
+	memory = 0;
+	for (int i = (int)pool.size() - 1; i >= 0; --i)
+	{
+		if (used[i])
+		{
+			pool[i].unused_frames = 0;
+			memory += getTargetBytes(pool[i].desc);
+			continue;
+		}
+		if (++pool[i].unused_frames < MAX_UNUSED_FRAMES)
+			continue;
+		delete pool[i].texture;
+		pool.erase(pool.begin() + i);
+	}
+}
+
+void FrameGraph::execute()
+{
+	for (int i = 0; i < passes.size(); ++i)
+		if (!passes[i].culled)
+			passes[i].execute(*this);
+}
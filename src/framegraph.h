@@ -0,0 +1,86 @@
+#pragma once
+
+#include "includes.h"
+#include <vector>
+#include <string>
+#include <functional>
+
+class Texture;
+
+namespace GTR {
+
+	//size and format of a render target, targets with the same description can share a texture
+	struct sTargetDesc {
+		int width;
+		int height;
+		unsigned int format;	//GL_RGBA, GL_RGB...
+		unsigned int type;		//GL_FLOAT, GL_UNSIGNED_BYTE...
+		unsigned int internal_format;	//0 for the default of the format and type
+
+		bool operator==(const sTargetDesc& other) const { return width == other.width && height == other.height && format == other.format && type == other.type && internal_format == other.internal_format; }
+	};
+
+	//bytes used by a texture with this description
+	size_t getTargetBytes(const sTargetDesc& desc);
+
+	//the passes of a frame declared with the targets they read and write
+	//the passes that do not lead to an output are culled and the transient targets
+	//whose lifetimes do not overlap share the same texture of the pool
+	class FrameGraph {
+	public:
+		struct sResource {
+			std::string name;
+			sTargetDesc desc;
+			Texture* texture;	//imported, or taken from the pool by compile
+			bool imported;
+			bool needed;		//read by a pass that is not culled, or an output
+			int first_pass;		//lifetime in the passes that are executed
+			int last_pass;
+		};
+
+		struct sPass {
+			std::string name;
+			std::vector<int> inputs;
+			std::vector<int> outputs;
+			std::function<void(FrameGraph&)> execute;
+			bool culled;
+		};
+
+		std::vector<sResource> resources;
+		std::vector<sPass> passes;
+
+		//stats of the last compile
+		int num_culled;
+		size_t memory;				//bytes of the pool textures used
+		size_t memory_no_aliasing;	//bytes if every transient target had its own texture
+
+		FrameGraph();
+		~FrameGraph();
+
+		//removes the passes and resources, the pool textures are kept for the next frame
+		void clear();
+
+		//a texture owned outside the graph, NULL for the screen
+		int importTexture(const char* name, Texture* texture, bool output = false);
+		//a texture that only lives while the passes that use it are executed
+		int createTarget(const char* name, const sTargetDesc& desc);
+		//passes must be added in the order they are executed
+		int addPass(const char* name, const std::vector<int>& inputs, const std::vector<int>& outputs, std::function<void(FrameGraph&)> execute);
+
+		//culls the passes and assigns the pool textures to the transient targets
+		void compile();
+		void execute();
+
+		Texture* getTexture(int resource) { return resources[resource].texture; }
+
+	private:
+		struct sPooledTexture {
+			Texture* texture;
+			sTargetDesc desc;
+			int free_from;		//pass from which it can be used by another target
+			int unused_frames;	//released when it is not needed for a while
+		};
+		std::vector<sPooledTexture> pool;
+	};
+
+};
@@ -0,0 +1,246 @@
+#include "glstate.h"
+
+#include <cstring>
+
+#define UNKNOWN_ENUM 0xFFFFFFFF
+
+long GLState::num_calls = 0;
+long GLState::num_skipped = 0;
+long GLState::num_uniforms = 0;
+long GLState::num_uniforms_skipped = 0;
+long GLState::num_draw_calls = 0;
+long GLState::num_buffer_binds = 0;
+
+char GLState::caps[NUM_CAPS] = { -1, -1, -1 };
+GLenum GLState::blend_src = UNKNOWN_ENUM;
+GLenum GLState::blend_dst = UNKNOWN_ENUM;
+GLenum GLState::depth_func = UNKNOWN_ENUM;
+char GLState::depth_mask = -1;
+GLenum GLState::cull_mode = UNKNOWN_ENUM;
+GLuint GLState::program = 0;
+bool GLState::program_known = false;
+int GLState::active_unit = -1;
+GLuint GLState::textures[MAX_TEXTURE_UNITS][NUM_TARGETS];
+bool GLState::textures_known[MAX_TEXTURE_UNITS][NUM_TARGETS];
+GLuint GLState::vertex_array = 0;
+bool GLState::vertex_array_known = false;
+
+int GLState::getCapIndex(GLenum cap)
+{
+	switch (cap)
+	{
+	case GL_BLEND: return CAP_BLEND;
+	case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+	case GL_CULL_FACE: return CAP_CULL_FACE;
+	}
+	return -1;
+}
+
+int GLState::getTargetIndex(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return TARGET_2D;
+	case GL_TEXTURE_CUBE_MAP: return TARGET_CUBE_MAP;
+	case GL_TEXTURE_3D: return TARGET_3D;
+	}
+	return -1;
+}
+
+void GLState::enable(GLenum cap)
+{
+	int index = getCapIndex(cap);
+	if (index != -1)
+	{
+		if (caps[index] == 1)
+		{
+			num_skipped++;
+			return;
+		}
+		caps[index] = 1;
+	}
+	glEnable(cap);
+	num_calls++;
+}
+
+void GLState::disable(GLenum cap)
+{
+	int index = getCapIndex(cap);
+	if (index != -1)
+	{
+		if (caps[index] == 0)
+		{
+			num_skipped++;
+			return;
+		}
+		caps[index] = 0;
+	}
+	glDisable(cap);
+	num_calls++;
+}
+
+void GLState::blendFunc(GLenum sfactor, GLenum dfactor)
+{
+	if (blend_src == sfactor && blend_dst == dfactor)
+	{
+		num_skipped++;
+		return;
+	}
+	blend_src = sfactor;
+	blend_dst = dfactor;
+	glBlendFunc(sfactor, dfactor);
+	num_calls++;
+}
+
+void GLState::depthFunc(GLenum func)
+{
+	if (depth_func == func)
+	{
+		num_skipped++;
+		return;
+	}
+	depth_func = func;
+	glDepthFunc(func);
+	num_calls++;
+}
+
+void GLState::depthMask(bool write)
+{
+	if (depth_mask == (char)write)
+	{
+		num_skipped++;
+		return;
+	}
+	depth_mask = write;
+	glDepthMask(write);
+	num_calls++;
+}
+
+void GLState::cullFace(GLenum mode)
+{
+	if (cull_mode == mode)
+	{
+		num_skipped++;
+		return;
+	}
+	cull_mode = mode;
+	glCullFace(mode);
+	num_calls++;
+}
+
+void GLState::useProgram(GLuint program_id)
+{
+	if (program_known && program == program_id)
+	{
+		num_skipped++;
+		return;
+	}
+	program = program_id;
+	program_known = true;
+	glUseProgram(program_id);
+	num_calls++;
+}
+
+void GLState::activeTexture(int unit)
+{
+	if (active_unit == unit)
+	{
+		num_skipped++;
+		return;
+	}
+	active_unit = unit;
+	glActiveTexture(GL_TEXTURE0 + unit);
+	num_calls++;
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+	int target_index = getTargetIndex(target);
+	if (target_index == -1 || active_unit < 0 || active_unit >= MAX_TEXTURE_UNITS)
+	{
+		glBindTexture(target, texture);
+		num_calls++;
+		return;
+	}
+
+	if (textures_known[active_unit][target_index] && textures[active_unit][target_index] == texture)
+	{
+		num_skipped++;
+		return;
+	}
+	textures[active_unit][target_index] = texture;
+	textures_known[active_unit][target_index] = true;
+	glBindTexture(target, texture);
+	num_calls++;
+}
+
+void GLState::bindTexture(int unit, GLenum target, GLuint texture)
+{
+	//avoid changing the unit when the texture is already there
+	int target_index = getTargetIndex(target);
+	if (target_index != -1 && unit < MAX_TEXTURE_UNITS && textures_known[unit][target_index] && textures[unit][target_index] == texture)
+	{
+		num_skipped++;
+		return;
+	}
+	activeTexture(unit);
+	bindTexture(target, texture);
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+	if (vertex_array_known && vertex_array == vao)
+	{
+		num_skipped++;
+		return;
+	}
+	vertex_array = vao;
+	vertex_array_known = true;
+	glBindVertexArray(vao);
+	num_calls++;
+	num_buffer_binds++;
+}
+
+void GLState::forgetTexture(GLuint texture)
+{
+	//deleting a texture unbinds it from every unit
+	for (int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+		for (int j = 0; j < NUM_TARGETS; ++j)
+			if (textures[i][j] == texture)
+				textures_known[i][j] = false;
+}
+
+void GLState::forgetProgram(GLuint program_id)
+{
+	if (program == program_id)
+		program_known = false;
+}
+
+void GLState::forgetVertexArray(GLuint vao)
+{
+	if (vertex_array == vao)
+		vertex_array_known = false;
+}
+
+void GLState::invalidate()
+{
+	memset(caps, -1, sizeof(caps));
+	blend_src = blend_dst = UNKNOWN_ENUM;
+	depth_func = UNKNOWN_ENUM;
+	depth_mask = -1;
+	cull_mode = UNKNOWN_ENUM;
+	program_known = false;
+	vertex_array_known = false;
+	active_unit = -1;
+	memset(textures_known, 0, sizeof(textures_known));
+}
+
+void GLState::resetStats()
+{
+	num_calls = 0;
+	num_skipped = 0;
+	num_uniforms = 0;
+	num_uniforms_skipped = 0;
+	num_draw_calls = 0;
+	num_buffer_binds = 0;
+}
@@ -0,0 +1,70 @@
+/*  shadow copy of the OpenGL state
+	Every change goes through here so the calls that would set the value already in use are dropped.
+	Code that changes the state directly (like imgui) must call invalidate() after.
+*/
+
+#pragma once
+
+#include "includes.h"
+
+class GLState
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 16;
+
+	//capabilities (GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, others are not filtered)
+	static void enable(GLenum cap);
+	static void disable(GLenum cap);
+	static void setEnabled(GLenum cap, bool enabled) { if (enabled) enable(cap); else disable(cap); }
+
+	static void blendFunc(GLenum sfactor, GLenum dfactor);
+	static void depthFunc(GLenum func);
+	static void depthMask(bool write);
+	static void cullFace(GLenum mode);
+
+	static void useProgram(GLuint program);
+	static void activeTexture(int unit);
+	static void bindTexture(GLenum target, GLuint texture); //in the active unit
+	static void bindTexture(int unit, GLenum target, GLuint texture);
+
+	static void bindVertexArray(GLuint vao);
+	static GLuint getVertexArray() { return vertex_array_known ? vertex_array : 0; }
+
+	//the object is going to be deleted, its id could be reused
+	static void forgetTexture(GLuint texture);
+	static void forgetProgram(GLuint program);
+	static void forgetVertexArray(GLuint vao);
+
+	//marks everything as unknown so the next calls are always issued
+	static void invalidate();
+
+	//counters since the last resetStats
+	static long num_calls;			//state calls sent to the driver
+	static long num_skipped;		//state calls dropped because nothing changed
+	static long num_uniforms;		//uniforms uploaded
+	static long num_uniforms_skipped;	//uniforms with the same value already in the program
+	static long num_draw_calls;		//glDraw* calls of the meshes
+	static long num_buffer_binds;	//buffers bound to draw (vertex arrays count as one)
+	static void resetStats();
+
+private:
+	enum { CAP_BLEND, CAP_DEPTH_TEST, CAP_CULL_FACE, NUM_CAPS };
+	enum { TARGET_2D, TARGET_CUBE_MAP, TARGET_3D, NUM_TARGETS };
+
+	static char caps[NUM_CAPS];	//-1 unknown
+	static GLenum blend_src;
+	static GLenum blend_dst;
+	static GLenum depth_func;
+	static char depth_mask;
+	static GLenum cull_mode;
+	static GLuint program;
+	static bool program_known;
+	static int active_unit;
+	static GLuint textures[MAX_TEXTURE_UNITS][NUM_TARGETS];
+	static bool textures_known[MAX_TEXTURE_UNITS][NUM_TARGETS];
+	static GLuint vertex_array;
+	static bool vertex_array_known;
+
+	static int getCapIndex(GLenum cap);
+	static int getTargetIndex(GLenum target);
+};
@@ -0,0 +1,113 @@
+#include "jobs.h"
+
+JobSystem* JobSystem::get()
+{
+	//never deleted, the workers are just killed when the app exits
+	static JobSystem* instance = NULL;
+	if (!instance)
+	{
+		int cores = (int)std::thread::hardware_concurrency();
+		instance = new JobSystem(cores > 1 ? cores - 1 : 0);
+	}
+	return instance;
+}
+
+JobSystem::JobSystem(int num_workers)
+{
+	job = NULL;
+	num_tasks = 0;
+	next_task = 0;
+	pending = 0;
+	active = 0;
+	generation = 0;
+	quit = false;
+
+	for (int i = 0; i < num_workers; ++i)
+		workers.push_back(std::thread(&JobSystem::workerLoop, this));
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (int i = 0; i < (int)workers.size(); ++i)
+		workers[i].join();
+}
+
+void JobSystem::parallelFor(int num_tasks, const std::function<void(int)>& func)
+{
+	if (num_tasks <= 0)
+		return;
+
+	//nothing to split
+	if (!workers.size() || num_tasks == 1)
+	{
+		for (int i = 0; i < num_tasks; ++i)
+			func(i);
+		return;
+	}
+
+	{
+		//a worker could still be leaving the previous job, wait before touching the counters
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this] { return active == 0; });
+
+		job = &func;
+		this->num_tasks = num_tasks;
+		pending = num_tasks;
+		next_task = 0;
+		generation++;
+	}
+	wake.notify_all();
+
+	runTasks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] { return pending == 0; });
+	job = NULL;
+}
+
+void JobSystem::workerLoop()
+{
+	int last_generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, last_generation] { return quit || generation != last_generation; });
+			if (quit)
+				return;
+			last_generation = generation;
+			active++;
+		}
+
+		runTasks();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		active--;
+		if (active == 0)
+			done.notify_all();
+	}
+}
+
+void JobSystem::runTasks()
+{
+	while (true)
+	{
+		int task = next_task.fetch_add(1);
+		if (task >= num_tasks)
+			break;
+
+		(*job)(task);
+
+		//last task finished, wake up the caller
+		if (pending.fetch_sub(1) == 1)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			done.notify_all();
+		}
+	}
+}
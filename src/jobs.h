@@ -0,0 +1,48 @@
+/*  pool of worker threads
+	Used to split work that can be done in parallel (like collecting the render calls of many entities).
+	The calling thread also runs tasks, so it never sits idle waiting for the workers.
+*/
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+class JobSystem
+{
+public:
+	//shared pool with one thread per core (created the first time)
+	static JobSystem* get();
+
+	JobSystem(int num_workers);
+	~JobSystem();
+
+	//threads that run tasks, including the caller
+	int getNumThreads() const { return (int)workers.size() + 1; }
+
+	//calls func(task) for every task in [0, num_tasks) and returns when all have finished
+	//tasks can run in any order and in any thread
+	void parallelFor(int num_tasks, const std::function<void(int)>& func);
+
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable wake;	//new job for the workers
+	std::condition_variable done;	//the job has finished
+
+	const std::function<void(int)>* job;
+	std::atomic<int> num_tasks;
+	std::atomic<int> next_task;
+	std::atomic<int> pending;		//tasks not finished yet
+	int active;						//workers inside runTasks
+	int generation;					//increased for every job
+	bool quit;
+
+	void workerLoop();
+	void runTasks();
+};
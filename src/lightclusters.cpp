@@ -0,0 +1,135 @@
+#include "lightclusters.h"
+
+#include "camera.h"
+#include "scene.h"
+#include "jobs.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace GTR;
+
+LightClusters::LightClusters()
+{
+	memset(&block, 0, sizeof(block));
+	num_lights = 0;
+	num_entries = 0;
+	fov = aspect = near_plane = far_plane = 0;
+}
+
+//view space box that contains every cluster of the frustum
+void LightClusters::buildBoxes(Camera* camera)
+{
+	fov = camera->fov;
+	aspect = camera->aspect;
+	near_plane = camera->near_plane;
+	far_plane = camera->far_plane;
+
+	for (int z = 0; z <= CLUSTERS_Z; ++z)
+		slice_depths[z] = near_plane * pow(far_plane / near_plane, z / (float)CLUSTERS_Z);
+
+	float tan_y = tan(fov * 0.5 * DEG2RAD);
+	float tan_x = tan_y * aspect;
+
+	boxes.clear();
+	boxes.reserve(NUM_CLUSTERS);
+	for (int z = 0; z < CLUSTERS_Z; ++z)
+	{
+		float depths[2] = { slice_depths[z], slice_depths[z + 1] };
+		for (int y = 0; y < CLUSTERS_Y; ++y)
+			for (int x = 0; x < CLUSTERS_X; ++x)
+			{
+				float ndc_x[2] = { -1.0f + 2.0f * x / CLUSTERS_X, -1.0f + 2.0f * (x + 1) / CLUSTERS_X };
+				float ndc_y[2] = { -1.0f + 2.0f * y / CLUSTERS_Y, -1.0f + 2.0f * (y + 1) / CLUSTERS_Y };
+
+				//the corners of the cluster at both depths, the camera looks down -z
+				Vector3 bbmin(1e20f, 1e20f, 1e20f);
+				Vector3 bbmax(-1e20f, -1e20f, -1e20f);
+				for (int d = 0; d < 2; ++d)
+					for (int i = 0; i < 2; ++i)
+						for (int j = 0; j < 2; ++j)
+						{
+							Vector3 corner(ndc_x[i] * depths[d] * tan_x, ndc_y[j] * depths[d] * tan_y, -depths[d]);
+							bbmin.setMin(corner);
+							bbmax.setMax(corner);
+						}
+				Vector3 halfsize = (bbmax - bbmin) * 0.5;
+				boxes.add(bbmin + halfsize, halfsize);
+			}
+	}
+}
+
+void LightClusters::update(Camera* camera, const std::vector<LightEntity*>& lights, int page)
+{
+	if (boxes.size() != NUM_CLUSTERS || fov != camera->fov || aspect != camera->aspect || near_plane != camera->near_plane || far_plane != camera->far_plane)
+		buildBoxes(camera);
+
+	block.near_plane = near_plane;
+	block.slice_scale = CLUSTERS_Z / log(far_plane / near_plane);
+
+	//bounding sphere of every light in view space
+	spheres.clear();
+	unsigned int all_clusters_mask = 0;
+	for (int i = 0; i < lights.size(); ++i)
+	{
+		LightEntity* light = lights[i];
+		if (light->block_index == -1 || light->block_page != page)
+			continue;
+
+		unsigned int bit = 1u << light->block_index;
+		if (light->light_type == DIRECTIONAL)
+		{
+			all_clusters_mask |= bit;
+			continue;
+		}
+
+		sLightSphere sphere;
+		sphere.bit = bit;
+		light->getBoundingSphere(sphere.center, sphere.radius);
+		sphere.center = camera->view_matrix * sphere.center;
+		spheres.push_back(sphere);
+	}
+	num_lights = spheres.size();
+
+	//every slice writes only its own clusters
+	JobSystem::get()->parallelFor(CLUSTERS_Z, [this, all_clusters_mask](int slice) {
+		assignSlice(slice, all_clusters_mask);
+	});
+
+	num_entries = 0;
+	for (int i = 0; i < CLUSTERS_Z; ++i)
+		num_entries += slice_entries[i];
+}
+
+void LightClusters::assignSlice(int slice, unsigned int all_clusters_mask)
+{
+	const int clusters_per_slice = CLUSTERS_X * CLUSTERS_Y;
+	int start = slice * clusters_per_slice;
+	unsigned int* masks = &block.masks[start];
+	for (int i = 0; i < clusters_per_slice; ++i)
+		masks[i] = all_clusters_mask;
+
+	slice_entries[slice] = 0;
+	float slice_near = slice_depths[slice];
+	float slice_far = slice_depths[slice + 1];
+	unsigned char touched[clusters_per_slice];
+	eSIMDLevel level = getSIMDLevel();
+
+	for (int i = 0; i < spheres.size(); ++i)
+	{
+		const sLightSphere& sphere = spheres[i];
+
+		//most lights are far from most slices
+		float depth = -sphere.center.z;
+		if (depth + sphere.radius < slice_near || depth - sphere.radius > slice_far)
+			continue;
+
+		int count = testSphereBoxes(sphere.center, sphere.radius, boxes, start, clusters_per_slice, touched, level);
+		if (!count)
+			continue;
+		slice_entries[slice] += count;
+		for (int j = 0; j < clusters_per_slice; ++j)
+			if (touched[j])
+				masks[j] |= sphere.bit;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "framework.h"
+#include "culling.h"
+#include <vector>
+
+//forward declarations
+class Camera;
+
+namespace GTR {
+
+	class LightEntity;
+
+	//the view frustum is split in screen tiles and exponential depth slices
+	const int CLUSTERS_X = 16;
+	const int CLUSTERS_Y = 9;
+	const int CLUSTERS_Z = 24;
+	const int NUM_CLUSTERS = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+
+	//same layout (std140) as ClusterBlock in the shader atlas
+	struct sClusterBlock {
+		unsigned int masks[NUM_CLUSTERS];	//bit i is set if the light i of the light block touches the cluster
+		float near_plane;
+		float slice_scale;					//CLUSTERS_Z / log(far / near)
+		float padding[2];
+	};
+
+	//lists of the lights of a page of the light block that touch every cluster of a camera
+	//a page holds 32 lights, so the list of a cluster is stored as a mask
+	class LightClusters {
+	public:
+		sClusterBlock block;
+		BoxArraySoA boxes;	//view space box of every cluster, in the same order as the masks
+
+		//stats of the last update
+		int num_lights;		//point and spot lights assigned
+		int num_entries;	//sum of the lights of all the clusters
+
+		LightClusters();
+
+		//assigns the lights of one page to the clusters of this camera, directional lights are in all of them
+		void update(Camera* camera, const std::vector<LightEntity*>& lights, int page = 0);
+
+	private:
+		//light bounds in view space
+		struct sLightSphere {
+			Vector3 center;
+			float radius;
+			unsigned int bit;
+		};
+		std::vector<sLightSphere> spheres;
+
+		float slice_depths[CLUSTERS_Z + 1];	//distance to the camera of the planes between slices
+		int slice_entries[CLUSTERS_Z];		//filled by every task, added at the end
+
+		//projection used to build the boxes, they only change with it
+		float fov;
+		float aspect;
+		float near_plane;
+		float far_plane;
+
+		void buildBoxes(Camera* camera);
+		void assignSlice(int slice, unsigned int all_clusters_mask);
+	};
+
+};
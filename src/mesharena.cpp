@@ -0,0 +1,234 @@
+#include "mesharena.h"
+#include "mesh.h"
+#include "shader.h"
+#include "glstate.h"
+#include "utils.h"
+
+#include <cassert>
+#include <cstring>
+
+std::vector<MeshArena*> MeshArena::arenas;
+bool MeshArena::enabled = true;
+std::vector<MeshArena::sDrawCommand> MeshArena::commands;
+unsigned int MeshArena::indirect_vbo_id = 0;
+
+MeshArena::MeshArena()
+{
+	vertices_vbo_id = indices_vbo_id = 0;
+	memset(vao_ids, 0, sizeof(vao_ids));
+	num_vertices = num_indices = 0;
+}
+
+MeshArena::~MeshArena()
+{
+	clear();
+}
+
+void MeshArena::create()
+{
+	//binding the index buffer would change the vertex array in use
+	GLState::bindVertexArray(0);
+
+	glGenBuffers(1, &vertices_vbo_id);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_id);
+	glBufferData(GL_ARRAY_BUFFER, MAX_VERTICES * sizeof(Mesh::tInterleaved), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &indices_vbo_id);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_vbo_id);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, MAX_INDICES * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	checkGLErrors();
+}
+
+void MeshArena::clear()
+{
+	for (int i = 0; i < 2; ++i)
+		if (vao_ids[i])
+		{
+			GLState::forgetVertexArray(vao_ids[i]);
+			glDeleteVertexArrays(1, &vao_ids[i]);
+			vao_ids[i] = 0;
+		}
+	if (vertices_vbo_id)
+		glDeleteBuffers(1, &vertices_vbo_id);
+	if (indices_vbo_id)
+		glDeleteBuffers(1, &indices_vbo_id);
+	vertices_vbo_id = indices_vbo_id = 0;
+	num_vertices = num_indices = 0;
+}
+
+bool MeshArena::canPlace(Mesh* mesh)
+{
+	if (!enabled || !Mesh::use_vaos)
+		return false;
+	if (!mesh->m_indices.size() || (!mesh->vertices.size() && !mesh->interleaved.size()))
+		return false;
+	//the arena layout only has vertex, normal and uv
+	if (mesh->colors.size() || mesh->bones.size() || mesh->weights.size() || mesh->m_uvs1.size())
+		return false;
+	return mesh->getNumVertices() <= MAX_VERTICES && mesh->m_indices.size() + mesh->lod_indices.size() <= MAX_INDICES;
+}
+
+bool MeshArena::place(Mesh* mesh)
+{
+	if (!canPlace(mesh))
+		return false;
+
+	int num_mesh_vertices = mesh->getNumVertices();
+	int num_mesh_indices = (int)(mesh->m_indices.size() + mesh->lod_indices.size());
+
+	MeshArena* arena = NULL;
+	for (int i = 0; i < arenas.size(); ++i)
+		if (arenas[i]->num_vertices + num_mesh_vertices <= MAX_VERTICES && arenas[i]->num_indices + num_mesh_indices <= MAX_INDICES)
+		{
+			arena = arenas[i];
+			break;
+		}
+	if (!arena)
+	{
+		arena = new MeshArena();
+		arena->create();
+		arenas.push_back(arena);
+	}
+
+	//convert to the interleaved layout, the missing streams are left to zero
+	std::vector<Mesh::tInterleaved> data;
+	const Mesh::tInterleaved* vertex_data = NULL;
+	if (mesh->interleaved.size())
+		vertex_data = &mesh->interleaved[0];
+	else
+	{
+		data.resize(num_mesh_vertices);
+		memset(&data[0], 0, data.size() * sizeof(Mesh::tInterleaved));
+		for (int i = 0; i < num_mesh_vertices; ++i)
+		{
+			data[i].vertex = mesh->vertices[i];
+			if (i < mesh->normals.size())
+				data[i].normal = mesh->normals[i];
+			if (i < mesh->uvs.size())
+				data[i].uv = mesh->uvs[i];
+		}
+		vertex_data = &data[0];
+	}
+
+	GLState::bindVertexArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, arena->vertices_vbo_id);
+	glBufferSubData(GL_ARRAY_BUFFER, arena->num_vertices * sizeof(Mesh::tInterleaved), num_mesh_vertices * sizeof(Mesh::tInterleaved), vertex_data);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//the indices are not rebased, the draws use the base vertex instead
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena->indices_vbo_id);
+	int offset = arena->num_indices * sizeof(unsigned int);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, mesh->m_indices.size() * sizeof(unsigned int), &mesh->m_indices[0]);
+	if (mesh->lod_indices.size())
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset + mesh->m_indices.size() * sizeof(unsigned int), mesh->lod_indices.size() * sizeof(unsigned int), &mesh->lod_indices[0]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	checkGLErrors();
+
+	mesh->arena = arena;
+	mesh->arena_base_vertex = arena->num_vertices;
+	mesh->arena_first_index = arena->num_indices;
+	arena->num_vertices += num_mesh_vertices;
+	arena->num_indices += num_mesh_indices;
+	return true;
+}
+
+unsigned int MeshArena::getVAO(bool instanced)
+{
+	GLuint& vao = vao_ids[instanced ? 1 : 0];
+	if (vao)
+		return vao;
+
+	glGenVertexArrays(1, &vao);
+	GLState::bindVertexArray(vao);
+
+	int spacing = sizeof(Mesh::tInterleaved);
+	glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_id);
+	glEnableVertexAttribArray(ATTRIB_VERTEX);
+	glVertexAttribPointer(ATTRIB_VERTEX, 3, GL_FLOAT, GL_FALSE, spacing, 0);
+	glEnableVertexAttribArray(ATTRIB_NORMAL);
+	glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, spacing, (void*)sizeof(Vector3));
+	glEnableVertexAttribArray(ATTRIB_COORD);
+	glVertexAttribPointer(ATTRIB_COORD, 2, GL_FLOAT, GL_FALSE, spacing, (void*)(sizeof(Vector3) + sizeof(Vector3)));
+
+	if (instanced)
+		Mesh::setInstanceAttributes();
+
+	//the index buffer binding is stored in the vertex array
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_vbo_id);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	checkGLErrors();
+	return vao;
+}
+
+bool MeshArena::supportsMultiDrawIndirect()
+{
+	static int supported = -1;
+	if (supported == -1)
+	{
+#ifdef USE_GLEW
+		supported = (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance) ? 1 : 0;
+#else
+		supported = 0;
+#endif
+	}
+	return supported == 1;
+}
+
+void MeshArena::drawMultiple(unsigned int primitive, const sMultiDrawItem* items, int num_items, const Matrix44* models, int num_models)
+{
+	assert(Shader::current && "shader must be enabled");
+	if (!num_items)
+		return;
+
+	Mesh::uploadInstances(models, num_models);
+	GLState::bindVertexArray(getVAO(true));
+
+	//the base instance of every command selects its matrices
+	if (supportsMultiDrawIndirect())
+	{
+		commands.resize(num_items);
+		for (int i = 0; i < num_items; ++i)
+		{
+			const sMultiDrawItem& item = items[i];
+			assert(item.mesh->arena == this);
+			int first_index, count;
+			item.mesh->getArenaRange(item.lod, first_index, count);
+			sDrawCommand& command = commands[i];
+			command.count = count;
+			command.instance_count = item.num_instances;
+			command.first_index = item.mesh->arena_first_index + first_index;
+			command.base_vertex = item.mesh->arena_base_vertex;
+			command.base_instance = item.first_instance;
+			Mesh::num_triangles_rendered += (count / 3) * item.num_instances;
+			Mesh::num_meshes_rendered++;
+		}
+
+		if (!indirect_vbo_id)
+			glGenBuffers(1, &indirect_vbo_id);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_vbo_id);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, num_items * sizeof(sDrawCommand), NULL, GL_STREAM_DRAW);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, num_items * sizeof(sDrawCommand), &commands[0], GL_STREAM_DRAW);
+		GLState::num_buffer_binds++;
+		glMultiDrawElementsIndirect(primitive, GL_UNSIGNED_INT, 0, num_items, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		GLState::num_draw_calls++;
+		checkGLErrors();
+		return;
+	}
+
+	//without base instance the model attribute is moved to the first matrix of every item
+	for (int i = 0; i < num_items; ++i)
+	{
+		const sMultiDrawItem& item = items[i];
+		assert(item.mesh->arena == this);
+		Mesh::setInstanceAttributes(item.first_instance);
+		item.mesh->drawCall(primitive, -1, item.num_instances, item.lod);
+	}
+	Mesh::setInstanceAttributes(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	checkGLErrors();
+}
@@ -0,0 +1,70 @@
+#ifndef MESHARENA_H
+#define MESHARENA_H
+
+#include "includes.h"
+#include "framework.h"
+#include <vector>
+
+class Mesh;
+
+//one element of a multi draw, a mesh (or one of its levels of detail) drawn with some consecutive instances
+struct sMultiDrawItem {
+	Mesh* mesh;
+	int lod;
+	int first_instance;	//first matrix of the item in the array passed to drawMultiple
+	int num_instances;
+};
+
+//big vertex and index buffers shared by many static meshes
+//every mesh gets a range of both buffers, so meshes of the same arena can be drawn
+//without changing the vertex array and several of them in one call
+//the space is never reused, meshes are not expected to be released while the app runs
+class MeshArena {
+public:
+	static const int MAX_VERTICES = 1 << 19;	//interleaved vertices (16MB)
+	static const int MAX_INDICES = 1 << 21;		//unsigned ints (8MB)
+
+	static std::vector<MeshArena*> arenas;
+	static bool enabled; //only affects the meshes uploaded after changing it
+
+	unsigned int vertices_vbo_id;
+	unsigned int indices_vbo_id;
+	unsigned int vao_ids[2]; //[0] regular, [1] instanced
+	int num_vertices;
+	int num_indices;
+
+	MeshArena();
+	~MeshArena();
+
+	//the mesh must be indexed and use only vertices, normals and uvs
+	static bool canPlace(Mesh* mesh);
+	//copies the mesh to the first arena with space, returns false if it must use its own buffers
+	static bool place(Mesh* mesh);
+
+	//vertex array of the arena in the fixed attribute locations (see eVertexAttribLocation)
+	unsigned int getVAO(bool instanced);
+
+	//draws all the items with the shader in use, it must read the model from the attribute u_model
+	//with multi draw indirect it is a single call, otherwise one instanced call per item
+	void drawMultiple(unsigned int primitive, const sMultiDrawItem* items, int num_items, const Matrix44* models, int num_models);
+
+	//glMultiDrawElementsIndirect with base instance (GL 4.3)
+	static bool supportsMultiDrawIndirect();
+
+private:
+	void create();
+	void clear();
+
+	//one command of glMultiDrawElementsIndirect
+	struct sDrawCommand {
+		unsigned int count;
+		unsigned int instance_count;
+		unsigned int first_index;
+		int base_vertex;
+		unsigned int base_instance;
+	};
+	static std::vector<sDrawCommand> commands;
+	static unsigned int indirect_vbo_id;
+};
+
+#endif
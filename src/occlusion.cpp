@@ -0,0 +1,290 @@
+#include "occlusion.h"
+#include "jobs.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define OCCLUSION_SSE
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#define TARGET_SSE
+	#else
+		#define TARGET_SSE __attribute__((target("sse")))
+	#endif
+#endif
+
+//below this w the vertex is too close to the camera (or behind it)
+const float MIN_CLIP_W = 0.0001f;
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+{
+	num_occluders = 0;
+	num_triangles = 0;
+	resize(width, height);
+}
+
+void OcclusionBuffer::resize(int width, int height)
+{
+	tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+	this->width = tiles_x * TILE_SIZE;
+	this->height = tiles_y * TILE_SIZE;
+	depth.resize(this->width * this->height);
+	tile_max.resize(tiles_x * tiles_y);
+	clear(viewprojection);
+}
+
+void OcclusionBuffer::clear(const Matrix44& viewprojection)
+{
+	this->viewprojection = viewprojection;
+	std::fill(depth.begin(), depth.end(), 1.0f);
+	std::fill(tile_max.begin(), tile_max.end(), 1.0f);
+	triangles.clear();
+	num_occluders = 0;
+	num_triangles = 0;
+}
+
+void OcclusionBuffer::addOccluder(const Matrix44& model, const Vector3* vertices, int stride, int num_vertices, const unsigned int* indices, int num_indices)
+{
+	Matrix44 mvp = model * viewprojection;
+
+	clip_vertices.resize(num_vertices);
+	const char* data = (const char*)vertices;
+	for (int i = 0; i < num_vertices; ++i)
+	{
+		const Vector3& v = *(const Vector3*)(data + i * stride);
+		clip_vertices[i] = mvp * Vector4(v, 1.0f);
+	}
+
+	int num = indices ? num_indices : num_vertices;
+	for (int i = 0; i + 2 < num; i += 3)
+	{
+		sScreenTriangle tri;
+		bool valid = true;
+		for (int j = 0; j < 3; ++j)
+		{
+			const Vector4& c = clip_vertices[indices ? indices[i + j] : i + j];
+
+			//triangles crossing the near plane are skipped, it only makes the culling less aggressive
+			if (c.w < MIN_CLIP_W)
+			{
+				valid = false;
+				break;
+			}
+			float inv_w = 1.0f / c.w;
+			tri.v[j].set((c.x * inv_w * 0.5f + 0.5f) * width, (c.y * inv_w * 0.5f + 0.5f) * height, c.z * inv_w * 0.5f + 0.5f);
+		}
+		if (!valid)
+			continue;
+
+		//pixels whose center may be inside
+		float min_x = std::min(tri.v[0].x, std::min(tri.v[1].x, tri.v[2].x));
+		float max_x = std::max(tri.v[0].x, std::max(tri.v[1].x, tri.v[2].x));
+		float min_y = std::min(tri.v[0].y, std::min(tri.v[1].y, tri.v[2].y));
+		float max_y = std::max(tri.v[0].y, std::max(tri.v[1].y, tri.v[2].y));
+		if (max_x < 0 || max_y < 0 || min_x >= width || min_y >= height)
+			continue;
+
+		tri.min_x = std::max(0, (int)floor(min_x));
+		tri.max_x = std::min(width - 1, (int)ceil(max_x));
+		tri.min_y = std::max(0, (int)floor(min_y));
+		tri.max_y = std::min(height - 1, (int)ceil(max_y));
+		triangles.push_back(tri);
+	}
+
+	num_occluders++;
+}
+
+void OcclusionBuffer::rasterize(bool use_threads)
+{
+	num_triangles = triangles.size();
+	if (!triangles.size())
+		return;
+
+	//bands of whole tile rows so every thread also owns its tiles
+	JobSystem* jobs = JobSystem::get();
+	int num_bands = use_threads ? std::min(tiles_y, jobs->getNumThreads()) : 1;
+	jobs->parallelFor(num_bands, [this, num_bands](int band) {
+		int start_tile = tiles_y * band / num_bands;
+		int end_tile = tiles_y * (band + 1) / num_bands;
+		rasterizeBand(start_tile * TILE_SIZE, end_tile * TILE_SIZE);
+		updateTiles(start_tile, end_tile);
+	});
+}
+
+//edge function in the form a*x + b*y + c, positive inside a counter clockwise triangle
+struct sEdge {
+	float a, b, c;
+	void setup(const Vector3& v0, const Vector3& v1)
+	{
+		a = v0.y - v1.y;
+		b = v1.x - v0.x;
+		c = -(a * v0.x + b * v0.y);
+	}
+};
+
+#ifdef OCCLUSION_SSE
+//computes the depth of 4 pixels of a row at once, width is always a multiple of 4
+TARGET_SSE static void rasterizeRowSSE(float* row, int start_x, int end_x, float py, const sEdge* edges, float zx, float zy, float z0)
+{
+	const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	__m128 edge_a[3], edge_row[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		edge_a[i] = _mm_set1_ps(edges[i].a);
+		edge_row[i] = _mm_set1_ps(edges[i].b * py + edges[i].c);
+	}
+	__m128 depth_x = _mm_set1_ps(zx);
+	__m128 depth_row = _mm_set1_ps(zy * py + z0);
+
+	for (int x = start_x & ~3; x <= end_x; x += 4)
+	{
+		__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+		__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[0], px), edge_row[0]), zero);
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[1], px), edge_row[1]), zero));
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[2], px), edge_row[2]), zero));
+		if (!_mm_movemask_ps(inside))
+			continue;
+
+		__m128 z = _mm_add_ps(_mm_mul_ps(depth_x, px), depth_row);
+		__m128 old_z = _mm_loadu_ps(row + x);
+		__m128 new_z = _mm_min_ps(old_z, z);
+		_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_z), _mm_andnot_ps(inside, old_z)));
+	}
+}
+#else
+//one pixel at a time, without SSE
+static void rasterizeRowScalar(float* row, int start_x, int end_x, float py, const sEdge* edges, float zx, float zy, float z0)
+{
+	for (int x = start_x; x <= end_x; ++x)
+	{
+		float px = x + 0.5f;
+		if (edges[0].a * px + edges[0].b * py + edges[0].c < 0 ||
+			edges[1].a * px + edges[1].b * py + edges[1].c < 0 ||
+			edges[2].a * px + edges[2].b * py + edges[2].c < 0)
+			continue;
+		float z = zx * px + zy * py + z0;
+		if (z < row[x])
+			row[x] = z;
+	}
+}
+#endif
+
+void OcclusionBuffer::rasterizeBand(int start_y, int end_y)
+{
+	for (int t = 0; t < (int)triangles.size(); ++t)
+	{
+		const sScreenTriangle& tri = triangles[t];
+		int min_y = std::max(tri.min_y, start_y);
+		int max_y = std::min(tri.max_y, end_y - 1);
+		if (min_y > max_y)
+			continue;
+
+		//make it counter clockwise so the inside is always positive
+		Vector3 v0 = tri.v[0];
+		Vector3 v1 = tri.v[1];
+		Vector3 v2 = tri.v[2];
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		if (fabs(area) < 1e-6f)
+			continue;
+		if (area < 0)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		sEdge edges[3];
+		edges[0].setup(v1, v2); //weight of v0
+		edges[1].setup(v2, v0); //weight of v1
+		edges[2].setup(v0, v1); //weight of v2
+
+		//depth is linear in screen space, z = zx * x + zy * y + z0
+		float inv_area = 1.0f / area;
+		float zx = (edges[0].a * v0.z + edges[1].a * v1.z + edges[2].a * v2.z) * inv_area;
+		float zy = (edges[0].b * v0.z + edges[1].b * v1.z + edges[2].b * v2.z) * inv_area;
+		float z0 = (edges[0].c * v0.z + edges[1].c * v1.z + edges[2].c * v2.z) * inv_area;
+
+		for (int y = min_y; y <= max_y; ++y)
+		{
+			float* row = &depth[y * width];
+#ifdef OCCLUSION_SSE
+			rasterizeRowSSE(row, tri.min_x, tri.max_x, y + 0.5f, edges, zx, zy, z0);
+#else
+			rasterizeRowScalar(row, tri.min_x, tri.max_x, y + 0.5f, edges, zx, zy, z0);
+#endif
+		}
+	}
+}
+
+void OcclusionBuffer::updateTiles(int start_tile_y, int end_tile_y)
+{
+	for (int ty = start_tile_y; ty < end_tile_y; ++ty)
+		for (int tx = 0; tx < tiles_x; ++tx)
+		{
+			float max_depth = 0.0f;
+			for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; ++y)
+			{
+				const float* row = &depth[y * width + tx * TILE_SIZE];
+				for (int x = 0; x < TILE_SIZE; ++x)
+					max_depth = std::max(max_depth, row[x]);
+			}
+			tile_max[ty * tiles_x + tx] = max_depth;
+		}
+}
+
+bool OcclusionBuffer::isOccluded(const BoundingBox& box) const
+{
+	//screen rect and nearest depth of the box
+	float min_x = 1e10f, min_y = 1e10f, min_z = 1e10f;
+	float max_x = -1e10f, max_y = -1e10f;
+	for (int i = 0; i < 8; ++i)
+	{
+		Vector3 corner(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+		corner = box.center + box.halfsize * corner;
+		Vector4 c = viewprojection * Vector4(corner, 1.0f);
+		if (c.w < MIN_CLIP_W)
+			return false;
+		float inv_w = 1.0f / c.w;
+		float x = (c.x * inv_w * 0.5f + 0.5f) * width;
+		float y = (c.y * inv_w * 0.5f + 0.5f) * height;
+		float z = c.z * inv_w * 0.5f + 0.5f;
+		min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+		min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+		min_z = std::min(min_z, z);
+	}
+
+	//nothing drawn can be in front
+	if (min_z <= 0.0f)
+		return false;
+
+	int x0 = std::max(0, (int)floor(min_x));
+	int x1 = std::min(width - 1, (int)ceil(max_x));
+	int y0 = std::max(0, (int)floor(min_y));
+	int y1 = std::min(height - 1, (int)ceil(max_y));
+	if (x0 > x1 || y0 > y1)
+		return false; //outside the screen, the frustum culling decides
+
+	for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ++ty)
+		for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; ++tx)
+		{
+			//the whole tile is in front of the box
+			if (tile_max[ty * tiles_x + tx] < min_z)
+				continue;
+
+			//check the pixels of the tile covered by the box
+			int px0 = std::max(x0, tx * TILE_SIZE), px1 = std::min(x1, (tx + 1) * TILE_SIZE - 1);
+			int py0 = std::max(y0, ty * TILE_SIZE), py1 = std::min(y1, (ty + 1) * TILE_SIZE - 1);
+			for (int y = py0; y <= py1; ++y)
+			{
+				const float* row = &depth[y * width];
+				for (int x = px0; x <= px1; ++x)
+					if (row[x] >= min_z)
+						return false;
+			}
+		}
+
+	return true;
+}
@@ -0,0 +1,62 @@
+/*  software occlusion culling
+	Rasterizes a few big meshes (occluders) in a low resolution depth buffer on the CPU and tests bounding boxes against it.
+	The buffer keeps the farthest depth of every tile so most of the boxes can be accepted or rejected without reading pixels.
+	It does not use OpenGL, so it can run without a GPU.
+*/
+
+#pragma once
+
+#include "framework.h"
+#include <vector>
+
+class OcclusionBuffer
+{
+public:
+	static const int TILE_SIZE = 8; //pixels per side of every tile of the hierarchy
+
+	int width;
+	int height;
+	int tiles_x;
+	int tiles_y;
+
+	std::vector<float> depth;		//nearest occluder depth of every pixel (0 near, 1 far or empty)
+	std::vector<float> tile_max;	//farthest depth inside every tile
+
+	Matrix44 viewprojection;
+
+	//stats
+	int num_occluders;
+	int num_triangles;	//triangles rasterized in the last frame
+
+	//width and height are rounded up to a multiple of TILE_SIZE
+	OcclusionBuffer(int width = 256, int height = 128);
+
+	void resize(int width, int height);
+
+	//empties the buffer for a new view
+	void clear(const Matrix44& viewprojection);
+
+	//adds the triangles of a mesh, the vertex positions are read every stride bytes
+	//indices can be NULL for meshes without indices
+	void addOccluder(const Matrix44& model, const Vector3* vertices, int stride, int num_vertices, const unsigned int* indices, int num_indices);
+
+	//rasterizes all the occluders, the screen is split in horizontal bands between the worker threads
+	void rasterize(bool use_threads = true);
+
+	//true if the box is completely behind the occluders, boxes crossing the near plane are never occluded
+	//it is read only so it can be called from several threads
+	bool isOccluded(const BoundingBox& box) const;
+
+private:
+	//triangle already in screen space
+	struct sScreenTriangle {
+		Vector3 v[3];		//x, y in pixels, z depth from 0 to 1
+		int min_x, max_x;
+		int min_y, max_y;
+	};
+	std::vector<sScreenTriangle> triangles;
+	std::vector<Vector4> clip_vertices;
+
+	void rasterizeBand(int start_y, int end_y);
+	void updateTiles(int start_tile_y, int end_tile_y);
+};
@@ -1,1178 +1,2881 @@
-#include "renderer.h"
-
-#include "camera.h"
-#include "shader.h"
-#include "mesh.h"
-#include "texture.h"
-#include "prefab.h"
-#include "material.h"
-#include "utils.h"
-#include "scene.h"
-#include "extra/hdre.h"
-#include "application.h"
-#include <algorithm>
-#include "sphericalharmonics.h"
-
-using namespace GTR;
-
-sProbe probe;
-
-Renderer::Renderer() {
-	w = Application::instance->window_width;
-	h = Application::instance->window_height;
-
-	average_lum = 1.0;
-	lum_white = 1.0;
-	scale_tm = 1.0;
-
-	render_mode = eRenderMode::DEFAULT;
-	pipeline_mode = ePipelineMode::DEFERRED;
-	blend_mode = FORWARD_BLEND;
-
-	fbo.create(w, h, 1, GL_RGBA, GL_FLOAT, true);
-
-	if (apply_irr)
-	{
-		irr_fbo = NULL;
-
-		irr_start_pos = Vector3(-230, 36, -342);
-		irr_end_pos = Vector3(530, 433, 460);
-		irr_dim = Vector3(8, 6, 12);
-		irr_delta = (irr_end_pos - irr_start_pos);
-		irr_normal_dist = 1.0;
-
-		defineAndPosGridProbe(GTR::Scene::instance);
-	}
-
-	fx_blur_buffer = new Texture(w, h, GL_RGBA, GL_FLOAT);
-	fx_threshold_buffer = new Texture(w, h, GL_RGBA, GL_FLOAT);
-	fx_bloom_buffer = new Texture(w, h, GL_RGBA, GL_FLOAT);
-	fx_aa_buffer = new Texture(w, h, GL_RGBA, GL_FLOAT);
-	fx_dof_buffer = new Texture(w, h, GL_RGBA, GL_FLOAT);
-	fx_dof_blurred_buffer = new Texture(w, h, GL_RGBA, GL_FLOAT);
-	fx_dof_blurred_buffer_2 = new Texture(w, h, GL_RGBA, GL_FLOAT);
-}
-
-
-void Renderer::render(GTR::Scene* scene, Camera* camera) {
-
-	renderSceneShadowmaps(scene);
-
-	if (show_fbo) {
-		if (showCameraDirectional) 
-			renderToFbo(scene, scene->lights[3]);
-		else 
-			renderToFbo(scene, scene->lights[0]);
-	}
-	else {
-		//renderToFbo(scene, camera, &fbo);
-		renderScene(scene, camera, pipeline_mode);
-	}
-}
-
-void Renderer::renderForward(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera) {
-
-	//set the clear color (the background color)
-	glClearColor(scene->background_color.x, scene->background_color.y, scene->background_color.z, 1.0);
-
-	// Clear the color and the depth buffer
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	checkGLErrors();
-
-	if (scene->enviroment) {
-		renderSkybox(scene->enviroment, camera);
-	}
-
-	for (size_t i = 0; i < rendercalls.size(); i++)
-	{
-		renderCall& rc = rendercalls[i];
-		renderMeshWithMaterial(render_mode, scene, rc.model, rc.mesh, rc.material, camera);
-	}
-}
-
-void Renderer::renderDeferred(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera) {
-
-	int w = Application::instance->window_width;
-	int h = Application::instance->window_height;
-
-
-	if (gbuffers_fbo.fbo_id == 0) {
-		gbuffers_fbo.create(w, h, 3, GL_RGBA,GL_UNSIGNED_BYTE);
-		decals_fbo.create(w, h, 3, GL_RGBA, GL_UNSIGNED_BYTE);
-	}
-
-	gbuffers_fbo.bind();
-
-		renderGBuffers(scene, rendercalls, camera);
-
-	gbuffers_fbo.unbind();
-
-	gbuffers_fbo.color_textures[0]->copyTo(decals_fbo.color_textures[0]);
-	gbuffers_fbo.color_textures[1]->copyTo(decals_fbo.color_textures[1]);
-	gbuffers_fbo.color_textures[2]->copyTo(decals_fbo.color_textures[2]);
-
-	decals_fbo.bind();
-
-		gbuffers_fbo.depth_texture->copyTo(NULL);
-		renderDecalls(scene, camera);
-
-	decals_fbo.unbind();
-
-	decals_fbo.color_textures[0]->copyTo(gbuffers_fbo.color_textures[0]);
-	decals_fbo.color_textures[1]->copyTo(gbuffers_fbo.color_textures[1]);
-	decals_fbo.color_textures[2]->copyTo(gbuffers_fbo.color_textures[2]);
-
-	if (!ao_buffer)
-		ao_buffer = new Texture(w, h, GL_RED, GL_UNSIGNED_BYTE);
-
-	if (!ao_blur_buffer)
-		ao_blur_buffer = new Texture(w, h, GL_RED, GL_UNSIGNED_BYTE);
-
-	if (apply_ssao) {
-		ssao.apply(gbuffers_fbo.depth_texture, gbuffers_fbo.color_textures[1], camera, ao_buffer);
-		ssao.blurTexture(ao_buffer, ao_blur_buffer);
-	}
-
-	fbo.bind();	//textura final pre hdr
-	renderFinalFBO(&gbuffers_fbo, camera, scene, hdr, ao_buffer, rendercalls);
-	if (updateIrradianceOnce) { // Para que comience updateada la irradiancia
-		updateIrradianceCache(scene);
-		updateIrradianceOnce = false;
-	}
-	fbo.unbind();
-
-	// Aplicam AA
-	fx.aa(fbo.color_textures[0], fx_aa_buffer);
-
-	// Bloom
-	fx.treshold(fx_aa_buffer, fx_threshold_buffer);
-	fx.horizontal = false;
-	fx.blur(fx_threshold_buffer, fx_blur_buffer);
-	fx.horizontal = true;
-	fx.blur(fx_blur_buffer, fx_threshold_buffer);
-	fx.bloom(fx_aa_buffer, fx_threshold_buffer, fx_bloom_buffer);
-
-	// Aplicam DoF
-	fx.horizontal = false;
-	fx.blur(fx_bloom_buffer, fx_dof_blurred_buffer);
-	fx.horizontal = true;
-	fx.blur(fx_dof_blurred_buffer, fx_dof_blurred_buffer_2);
-	fx.dof(fx_bloom_buffer, fx_dof_blurred_buffer_2, fbo.depth_texture, camera, fx_dof_buffer);
-
-	Shader* final_shader = Shader::Get("tonemapper"); //este aplica tonemapper
-
-	final_shader->enable();
-	final_shader->setUniform("u_average_lum", average_lum);
-	final_shader->setUniform("u_lumwhite2", lum_white * lum_white);
-	final_shader->setUniform("u_scale", scale_tm);
-
-	if (hdr) {
-		if (use_only_FXAA)
-			fx_aa_buffer->toViewport(final_shader);
-		else if (use_bloom_dof)
-			fx_dof_buffer->toViewport(final_shader);
-		else
-			fbo.color_textures[0]->toViewport(final_shader);
-	}
-	else
-		fbo.color_textures[0]->toViewport();
-
-	glDisable(GL_BLEND);
-
-	final_shader->disable();
-
-	if (show_gbuffers)
-		view_gbuffers(camera);
-	else if (show_ao_buffer)
-		ao_blur_buffer->toViewport();
-	else if (show_depthfbo) {
-		Shader* depthShader = Shader::Get("depth");
-
-		depthShader->enable();
-		depthShader->setUniform("u_camera_nearfar", Vector2(camera->near_plane, camera->far_plane));
-
-		fbo.depth_texture->toViewport(depthShader);
-		depthShader->disable();
-
-		glViewport(0, 0, w, h);
-	}
-
-}
-
-void Renderer::renderSkybox(Texture* skybox, Camera* camera)
-{
-	Mesh* mesh = Mesh::Get("data/meshes/sphere.obj", false);
-	Shader* shader = Shader::Get("skybox");
-	shader->enable();
-
-	Matrix44 m;
-	m.translate(camera->eye.x, camera->eye.y, camera->eye.z);
-	m.scale(5, 5, 5);
-
-	shader->setUniform("u_model", m);
-	shader->setUniform("u_viewprojection", camera->viewprojection_matrix);
-	shader->setUniform("u_camera_pos", camera->eye);
-
-	shader->setTexture("u_enviroment_texture", skybox, 0);
-
-	glDisable(GL_BLEND);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
-
-	mesh->render(GL_TRIANGLES);
-
-	glEnable(GL_CULL_FACE);
-	glEnable(GL_DEPTH_TEST);
-}
-
-void Renderer::renderFinalFBO(FBO* gbuffers_fbo, Camera* camera, GTR::Scene* scene, bool hdr, Texture* ao_buffer, std::vector <renderCall>& rendercalls) {
-
-	glClearColor(0, 0, 0, 0);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	checkGLErrors();
-
-	glDisable(GL_BLEND);
-	glDisable(GL_DEPTH_TEST);
-
-	Mesh* mesh;
-	Shader* shader;
-
-	Mesh* sphere = Mesh::Get("data/meshes/sphere.obj", true);
-	Mesh* quad = Mesh::getQuad();
-
-	gbuffers_fbo->depth_texture->copyTo(NULL);
-
-	for (size_t i = 0; i < scene->lights.size(); i++) {
-
-		LightEntity* light = scene->lights[i];
-
-		shader = Shader::Get("deferred");
-		shader->enable();
-		mesh = quad;
-		bool first_iter = (i == 0);
-		bool last_iter = (i == scene->lights.size()-1);
-
-		setUniformsLight(light, camera, scene, ao_buffer, shader, hdr, gbuffers_fbo, first_iter);
-
-		shader->setUniform("u_apply_irr", apply_irr);
-		shader->setUniform("u_tri_irr", apply_tri_irr);
-		shader->setUniform("u_num_probes", (float)probes.size());
-		shader->setUniform("u_irr_start", irr_start_pos);
-		shader->setUniform("u_irr_end", irr_end_pos);
-		shader->setUniform("u_irr_dims", irr_dim);
-		shader->setUniform("u_irr_delta", irr_delta);
-		shader->setUniform("u_irr_normal_dist", irr_normal_dist);
-		shader->setUniform("u_probes_texture", probes_texture, 6);
-		shader->setUniform("u_last_iter", last_iter);
-		shader->setTexture("u_enviroment_texture", scene->enviroment, 7);
-		shader->setUniform("u_use_reflections", use_reflections);
-
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_ONE, GL_ONE);
-
-		mesh->render(GL_TRIANGLES);
-
-		shader->disable();
-	}
-
-	if (blend_mode == FORWARD_BLEND) {
-		glEnable(GL_BLEND);
-		glEnable(GL_DEPTH_TEST);
-		for (size_t i = 0; i < rendercalls.size(); i++)
-		{
-			renderCall& rc = rendercalls[i];
-			if (rc.material->alpha_mode != eAlphaMode::BLEND) continue;
-			renderMeshWithMaterial(eRenderMode::SINGLE, scene, rc.model, rc.mesh, rc.material, camera);
-		}
-
-	}
-
-	glDisable(GL_BLEND);
-	glDisable(GL_DEPTH_TEST);
-	
-	if (use_volumetric)
-		computeVolumetric(camera, gbuffers_fbo->depth_texture, scene);
-
-	int numProbes = probes.size();
-	//now compute the coeffs for every probe
-	if (render_probes)
-	{
-		for (int iP = 0; iP < numProbes; ++iP) {
-			int probe_index = iP;
-			renderProbe(probes[iP].pos, 3.0, probes[iP].sh.coeffs[0].v);
-		}
-	}
-
-	if (irr_fbo && show_irr_fbo) {
-		irr_fbo->color_textures[0]->toViewport();
-	}
-	if (show_probes_text && probes_texture) {
-		probes_texture->toViewport();
-	}
-
-}
-
-void Renderer::view_gbuffers(Camera* camera) {
-
-	//FBO* fbo = &gbuffers_fbo;
-	FBO* fbo = &decals_fbo;
-
-	glViewport(0, h * 0.5, w * 0.5, h * 0.5);
-	fbo->color_textures[0]->toViewport();
-	glViewport(w * 0.5, h * 0.5, w * 0.5, h * 0.5);
-	fbo->color_textures[1]->toViewport();
-	glViewport(0, 0, w * 0.5, h * 0.5);
-	fbo->color_textures[2]->toViewport();
-	glViewport(w * 0.5, 0, w * 0.5, h * 0.5);
-
-	Shader* depthShader = Shader::Get("depth");
-
-	depthShader->enable();
-	depthShader->setUniform("u_camera_nearfar", Vector2(camera->near_plane, camera->far_plane));
-
-	fbo->depth_texture->toViewport(depthShader);
-	depthShader->disable();
-
-	glViewport(0, 0, w, h);
-}
-
-void Renderer::computeVolumetric(Camera* camera, Texture* depth_texture, Scene* scene) {
-	// Volumetric rendering
-
-	Mesh* quad_volum = Mesh::getQuad();
-	Shader* sh = Shader::Get("volume_direct");
-	sh->enable();
-
-	Matrix44 inv_vp = camera->viewprojection_matrix;
-	inv_vp.inverse();
-
-	sh->setUniform("u_inverse_viewprojection", inv_vp);
-	sh->setTexture("u_depth_texture", depth_texture, 3);
-	sh->setUniform("u_camera_pos", camera->eye);
-
-	LightEntity* light = scene->lights[3];
-	light->setLightUniforms(sh, true);
-
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_DEPTH_TEST);
-
-	quad_volum->render(GL_TRIANGLES);
-	glDisable(GL_BLEND);
-
-	sh->disable();
-}
-
-void Renderer::setUniformsLight(LightEntity* light, Camera* camera, GTR::Scene* scene, Texture* ao_buffer, Shader* shader, bool hdr, FBO* gbuffers_fbo, bool first_iter) {
-
-	shader->setUniform("u_viewprojection", camera->viewprojection_matrix);
-
-	Matrix44 inv_vp = camera->viewprojection_matrix;
-	inv_vp.inverse();
-
-	shader->setUniform("hdr", hdr);
-
-	shader->setUniform("u_camera_position", camera->eye);
-	shader->setUniform("u_inverse_viewprojection", inv_vp);
-
-	shader->setTexture("u_color_texture", gbuffers_fbo->color_textures[0], 0);
-
-	shader->setTexture("u_normal_texture", gbuffers_fbo->color_textures[1], 1);
-	shader->setTexture("u_extra_texture", gbuffers_fbo->color_textures[2], 2);
-	shader->setTexture("u_depth_texture", gbuffers_fbo->depth_texture, 3);
-
-	if (first_iter)
-		shader->setUniform("u_ambient_light", scene->ambient_light);
-	else 
-		shader->setUniform("u_ambient_light", Vector3());
-
-	shader->setUniform("u_first_iter", first_iter);
-
-	if (light->light_type == eLightType(0))
-		light->setLightUniforms(shader, false);
-	else
-		light->setLightUniforms(shader, true);
-
-	if (apply_ssao)
-		shader->setTexture("u_ao_texture", ao_buffer, 5);
-
-	shader->setUniform("u_apply_ssao", apply_ssao);
-}
-
-void Renderer::renderToFbo(GTR::Scene* scene, LightEntity* light) {
-
-
-	Shader* shader = Shader::Get("depth");
-
-	shader->enable();
-	glDisable(GL_DEPTH_TEST);
-
-	shader->setUniform("u_camera_nearfar", Vector2(light->camera.near_plane, light->camera.far_plane));
-
-	light->fbo->depth_texture->toViewport(shader);
-
-	glEnable(GL_DEPTH_TEST);
-	shader->disable();
-}
-
-void Renderer::collectRenderCalls(GTR::Scene* scene, Camera* camera) {
-
-	renderCallList.clear();
-
-	//render entities
-	for (int i = 0; i < scene->entities.size(); ++i)
-	{
-		BaseEntity* ent = scene->entities[i];
-		if (!ent->visible)
-			continue;
-
-		//is a prefab!
-		if (ent->entity_type == PREFAB)
-		{
-			PrefabEntity* pent = (GTR::PrefabEntity*)ent;
-			if (pent->prefab)
-				getRenderCallsFromPrefabs(ent->model, pent->prefab, camera);
-		}
-	}
-	if (camera)
-		std::sort(renderCallList.begin(), renderCallList.end(), compareNodes);
-}
-
-
-void Renderer::renderScene(GTR::Scene* scene, Camera* camera, ePipelineMode pipmode)
-{
-	collectRenderCalls(scene, camera);
-
-	if (pipmode == FORWARD)
-		renderForward(scene, renderCallList, camera);
-	else if (pipmode == DEFERRED)
-		renderDeferred(scene, renderCallList, camera);
-}
-
-//renders all the prefab
-void Renderer::getRenderCallsFromPrefabs(const Matrix44& model, GTR::Prefab* prefab, Camera* camera)
-{
-	assert(prefab && "PREFAB IS NULL");
-	//assign the model to the root node
-	getRenderCallsFromNode(model, &prefab->root, camera);
-}
-
-//renders a node of the prefab and its children
-void Renderer::getRenderCallsFromNode(const Matrix44& prefab_model, GTR::Node* node, Camera* camera)
-{
-	if (!node->visible)
-		return;
-
-	//compute global matrix
-	Matrix44 node_model = node->getGlobalMatrix(true) * prefab_model;
-
-	//does this node have a mesh? then we must render it
-	if (node->mesh && node->material)
-	{
-		//compute the bounding box of the object in world space (by using the mesh bounding box transformed to world space)
-		BoundingBox world_bounding = transformBoundingBox(node_model,node->mesh->box);
-
-		//if bounding box is inside the camera frustum then the object is probably visible
-		if (!camera || camera->testBoxInFrustum(world_bounding.center, world_bounding.halfsize))
-		{
-
-			renderCall aux;
-
-			aux.model = node_model;
-			aux.mesh = node->mesh;
-			aux.material = node->material;
-			if(camera)
-				aux.distance_to_cam = camera->eye.distance(world_bounding.center);
-			//uso el centro de la bounding box para la distancia
-
-			this->renderCallList.push_back(aux);
-
-		}
-	}
-
-	//iterate recursively with children
-	for (int i = 0; i < node->children.size(); ++i)
-		getRenderCallsFromNode(prefab_model, node->children[i], camera);
-}
-
-//renders a mesh given its transform and material
-void Renderer::renderMeshWithMaterial(eRenderMode mode, GTR::Scene* scene, const Matrix44 model, Mesh* mesh, GTR::Material* material, Camera* camera)
-{
-	//in case there is nothing to do
-	if (!mesh || !mesh->getNumVertices() || !material )
-		return;
-    assert(glGetError() == GL_NO_ERROR);
-
-	//define locals to simplify coding
-	Shader* shader = NULL;
-	Texture* texture = NULL;
-	texture = material->color_texture.texture;
-	if (texture == NULL)
-		texture = Texture::getWhiteTexture(); //a 1x1 white texture
-
-	if (rendering_shadowmap && mode == DEFAULT) {
-		renderMeshInShadowMap(material, camera, model, mesh, texture);
-		return;
-	}
-
-	Texture* metallic_roughness_texture = material->metallic_roughness_texture.texture;
-	if (metallic_roughness_texture == NULL)
-		metallic_roughness_texture = Texture::getWhiteTexture(); //a 1x1 white texture
-
-
-	Texture* emmisive_texture = material->emissive_texture.texture;
-	if (emmisive_texture == NULL)
-		emmisive_texture = Texture::getWhiteTexture(); //a 1x1 white texture
-
-	Texture* normalmap = material->normal_texture.texture;
-	if (!normalmap) {
-		normalmap = Texture::getWhiteTexture(); //a 1x1 white texture
-	}
-
-	//select the blending
-	if (material->alpha_mode == GTR::eAlphaMode::BLEND)
-	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	}
-	else
-		glDisable(GL_BLEND);
-
-	//select if render both sides of the triangles
-	if(material->two_sided)
-		glDisable(GL_CULL_FACE);
-	else
-		glEnable(GL_CULL_FACE);
-	assert(glGetError() == GL_NO_ERROR);
-
-	//chose a shader
-
-	switch (mode)
-	{
-	case GTR::DEFAULT:
-		shader = Shader::Get("multipasslight");
-		break;
-	case GTR::SHOW_TEXTURE:
-		shader = Shader::Get("texture");
-		break;
-	case GTR::SHOW_NORMAL:
-		shader = Shader::Get("normal");
-		break;
-	case GTR::SHOW_OCCLUSION:
-		shader = Shader::Get("occlusion");
-		break;
-	case GTR::SHOW_UVS:
-		shader = Shader::Get("uvs");
-		break;
-	case GTR::SINGLE:
-		shader = Shader::Get("basiclight");
-		break;
-	case GTR::GBUFFERS:
-		shader = Shader::Get("gbuffers");
-		break;
-	}
-
-	assert(glGetError() == GL_NO_ERROR);
-
-	//no shader? then nothing to render
-	if (!shader)
-		return;
-	shader->enable();
-
-	if (blend_mode == DITHERING) shader->setUniform("u_dithering", true);
-	if (blend_mode == FORWARD_BLEND) shader->setUniform("u_dithering", false);
-
-	//upload uniforms
-	if (camera) {
-		shader->setUniform("u_viewprojection", camera->viewprojection_matrix);
-		shader->setUniform("u_camera_position", camera->eye);
-	}
-
-	shader->setUniform("u_model", model );
-	float t = getTime();
-	shader->setUniform("u_time", t );
-
-	shader->setUniform("u_color", material->color);
-	shader->setUniform("u_emissive_factor", material->emissive_factor);
-
-	if (blend_mode != FORWARD_BLEND)
-		shader->setUniform("u_ambient_light", scene->ambient_light);
-	else
-		shader->setUniform("u_ambient_light", Vector3(0.0, 0.0, 0.0));
-
-	std::vector<GTR::LightEntity*> lightsScene = scene->lights;
-
-	if(texture)
-		shader->setUniform("u_texture", texture, 0);
-	if (metallic_roughness_texture)
-		shader->setUniform("u_metallic_roughness_texture", metallic_roughness_texture, 1);
-	if(emmisive_texture)
-		shader->setUniform("u_emmisive_texture", emmisive_texture, 2);
-	if(normalmap)
-		shader->setUniform("u_normalmap", normalmap, 3);
-
-	if (mode == GBUFFERS) {
-		shader->setUniform("u_roughness_factor", material->roughness_factor);
-		shader->setUniform("u_metallic_factor", material->metallic_factor);
-		//std::cout << "metallicf: " << material->metallic_factor << " roughnessf: " << material->roughness_factor << "\n";
-	}
-
-	//this is used to say which is the alpha threshold to what we should not paint a pixel on the screen (to cut polygons according to texture alpha)
-	shader->setUniform("u_alpha_cutoff", material->alpha_mode == GTR::eAlphaMode::MASK ? material->alpha_cutoff : 0);
-
-	if (mode == SINGLE) {
-		for (size_t i = 0; i < lightsScene.size() && i < 5; i++) {
-			light_types[i] = lightsScene[i]->light_type;
-			light_color[i] = lightsScene[i]->color;
-			light_intensity[i] = lightsScene[i]->intensity;
-			light_position[i] = lightsScene[i]->model.getTranslation();
-			light_maxdists[i] = lightsScene[i]->max_distance;
-			light_coscutoff[i] = cos((lightsScene[i]->cone_angle / 180.0) * PI);
-			light_spotexponent[i] = lightsScene[i]->spot_exponent;
-			light_target[i] = lightsScene[i]->model.frontVector();
-			light_vector[i] = lightsScene[i]->target;
-		}
-
-		int numlights = lightsScene.size();
-		shader->setUniform1Array("u_light_type", (int*)&light_types, numlights);
-		shader->setUniform3Array("u_light_pos", (float*)&light_position, numlights);
-		shader->setUniform3Array("u_light_target", (float*)&light_target, numlights);
-		shader->setUniform3Array("u_light_color", (float*)&light_color, numlights);
-		shader->setUniform1Array("u_light_max_dists", (float*)&light_maxdists, numlights);
-		shader->setUniform1Array("u_light_coscutoff", (float*)&light_coscutoff, numlights);
-		shader->setUniform1Array("u_light_spotexp", (float*)&light_spotexponent, numlights);
-		shader->setUniform1Array("u_light_spotexp", (float*)&light_intensity, numlights);
-		shader->setUniform("u_num_lights", numlights);
-		//do the draw call that renders the mesh into the screen
-		mesh->render(GL_TRIANGLES);
-	}
-
-	else if (mode == DEFAULT) {
-		for (size_t i = 0; i < lightsScene.size() && i < 5; i++) {
-			LightEntity* light = lightsScene[i];
-
-			light->setLightUniforms(shader, true);
-
-			if (i != 0) {
-				shader->setUniform("u_ambient_light", Vector3(0.0, 0.0, 0.0));
-				shader->setUniform("u_emissive_factor", Vector3(0.0, 0.0, 0.0));
-
-				glDepthFunc(GL_LEQUAL);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-
-				glEnable(GL_BLEND);
-			}
-			mesh->render(GL_TRIANGLES);
-		}
-		glDepthFunc(GL_LESS);
-	}
-
-	else {
-		mesh->render(GL_TRIANGLES);
-	}
-
-
-	//disable shader
-	shader->disable();
-
-	//set the render state as it was before to avoid problems with future renders
-	glDisable(GL_BLEND);
-}
-
-void Renderer::renderMeshInShadowMap(Material* material, Camera* camera, Matrix44 model, Mesh* mesh, Texture* texture)
-{
-	Shader* shader = Shader::Get("texture");
-
-	assert(glGetError() == GL_NO_ERROR);
-
-	if (material->alpha_mode == GTR::BLEND) return;
-
-	shader->enable();
-
-	shader->setUniform("u_texture", texture, 0);
-	shader->setUniform("u_color", material->color);
-	shader->setUniform("u_camera_pos", camera->eye);
-	shader->setUniform("u_model", model);
-	shader->setUniform("u_viewprojection", camera->viewprojection_matrix);
-	shader->setUniform("u_alpha_cutoff", material->alpha_mode == GTR::eAlphaMode::MASK ? material->alpha_cutoff : 0);
-
-	mesh->render(GL_TRIANGLES);
-
-}
-
-void Renderer::renderSceneShadowmaps(GTR::Scene* scene)
-{
-	rendering_shadowmap = true;
-	std::vector<GTR::LightEntity*> lightsScene = scene->lights;
-
-	for (size_t i = 0; i < lightsScene.size() && i < 5; i++) {
-		GTR::LightEntity* light = lightsScene[i];
-		if (!light->cast_shadows) continue;
-
-		if (!light->fbo) {
-			light->fbo = new FBO();
-			light->fbo->setDepthOnly(1024, 1024);
-		}
-
-		light->fbo->bind();
-		glColorMask(false, false, false, false);
-
-		glClear(GL_DEPTH_BUFFER_BIT);
-
-		Camera* light_cam = &light->camera;
-
-		//light_cam->enable();
-		renderScene(scene, light_cam, GTR::ePipelineMode::FORWARD);
-
-		light->fbo->unbind();
-		glColorMask(true, true, true, true);
-	}
-	rendering_shadowmap = false;
-}
-
-void Renderer::renderDecalls(GTR::Scene* scene, Camera* camera) { 
-
-	static Mesh* mesh = NULL;
-
-	if (mesh == NULL) {
-		mesh = new Mesh();
-		mesh->createCube();
-	}
-
-	Shader* shader = Shader::Get("decalls");
-
-	shader->enable();
-
-	Matrix44 inv_vp = camera->viewprojection_matrix;
-	inv_vp.inverse();
-	shader->setUniform("u_inverse_viewprojection", inv_vp);
-	shader->setUniform("u_viewprojection", camera->viewprojection_matrix);
-
-	shader->setUniform("u_camera_pos", camera->eye);
-	shader->setUniform("u_iRes", Vector2(1.0 / (float)gbuffers_fbo.depth_texture->width, 1.0 / (float)gbuffers_fbo.depth_texture->height));
-
-	shader->setTexture("u_color_texture", gbuffers_fbo.color_textures[0], 0);
-	shader->setTexture("u_normal_texture", gbuffers_fbo.color_textures[1], 1);
-	shader->setTexture("u_extra_texture", gbuffers_fbo.color_textures[2], 2);
-	shader->setTexture("u_depth_texture", gbuffers_fbo.depth_texture, 3);
-
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
-
-	for (int i = 0; i < scene->entities.size(); ++i) {
-		BaseEntity* ent = scene->entities[i];
-		if (ent->entity_type != eEntityType::DECAL)
-			continue;
-		
-		DecalEntity* dent = (DecalEntity*) ent;
-
-		shader->setUniform("u_model", ent->model);
-
-		Matrix44 inv_model = ent->model;
-		inv_model.inverse();
-		shader->setUniform("u_iModel", inv_model);
-		shader->setTexture("u_decal_texture", dent->albedo, 4);
-
-		mesh->render(GL_TRIANGLES);
-	}
-
-	shader->disable();
-}
-
-GTR::SSAOFX::SSAOFX() {
-	points = generateSpherePoints(64, 10.0, true);
-	intensity = 1.0f;
-}
-
-void GTR::SSAOFX::blurTexture(Texture* input, Texture* output)
-{
-	FBO* fbo = Texture::getGlobalFBO(output);
-	fbo->bind();
-
-	Mesh* quad = Mesh::getQuad();
-	Shader* sh = Shader::Get("blur");
-
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
-
-	sh->enable();
-	sh->setTexture("ssaoInput", input, 9);
-	quad->render(GL_TRIANGLES);
-	sh->disable();
-
-	fbo->unbind();
-}
-
-void GTR::SSAOFX::apply(Texture* depth_buffer, Texture* normal_buffer, Camera* cam, Texture* output) {
-
-	FBO* fbo = Texture::getGlobalFBO(output);
-	fbo->bind();
-
-	Matrix44 innvp = cam->viewprojection_matrix;
-	innvp.inverse();
-
-	Mesh* quad = Mesh::getQuad();
-
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
-
-	Shader* sh = Shader::Get("ssao");
-	sh->enable();
-	sh->setUniform("u_inverse_viewprojection", innvp);
-	sh->setUniform("u_iRes", Vector2(1.0 / (float)depth_buffer->width, 1.0 / (float)depth_buffer->height));
-	sh->setUniform3Array("u_points", points[0].v, points.size());
-
-	sh->setUniform("u_viewprojection", cam->viewprojection_matrix);
-	sh->setTexture("u_normal_texture", normal_buffer, 1);
-	sh->setTexture("u_depth_texture", depth_buffer, 3);
-	quad->render(GL_TRIANGLES);
-
-	sh->disable();
-
-	fbo->unbind();
-}
-
-std::vector<Vector3> GTR::generateSpherePoints(int num,
-	float radius, bool hemi)
-{
-	std::vector<Vector3> points;
-	points.resize(num);
-	for (int i = 0; i < num; i += 3)
-	{
-		Vector3& p = points[i];
-		float u = random();
-		float v = random();
-		float theta = u * 2.0 * PI;
-		float phi = acos(2.0 * v - 1.0);
-		float r = cbrt(random() * 0.9 + 0.1) * radius;
-		float sinTheta = sin(theta);
-		float cosTheta = cos(theta);
-		float sinPhi = sin(phi);
-		float cosPhi = cos(phi);
-		p.x = r * sinPhi * cosTheta;
-		p.y = r * sinPhi * sinTheta;
-		p.z = r * cosPhi;
-		if (hemi && p.z < 0)
-			p.z *= -1.0;
-	}
-	return points;
-}
-
-
-void GTR::Renderer::renderInMenu() {
-
-	if (pipeline_mode == GTR::ePipelineMode::DEFERRED) {
-		ImGui::Checkbox("Show gbuffers", &show_gbuffers);
-		ImGui::Checkbox("Show SSAO", &show_ao_buffer);
-		ImGui::Checkbox("Show depth fbo", &show_depthfbo);
-		ImGui::Checkbox("Apply tonemap", &hdr);
-		ImGui::Checkbox("Apply irr", &apply_irr);
-		ImGui::Checkbox("Use only FXAA", &use_only_FXAA);
-		ImGui::Checkbox("Use volumetric", &use_volumetric);
-		ImGui::Checkbox("Use reflection", &use_reflections);
-		ImGui::Checkbox("Use Bloom & DoF", &use_bloom_dof);
-		if (apply_irr)
-		{
-			ImGui::Checkbox("Apply trilinear interpolation irr", &apply_tri_irr);
-			if(ImGui::Button("Update Irr Cache", ImVec2(200.0, 20.0))) updateIrradianceCache(Scene::instance);
-			ImGui::Checkbox("Render Irradiance Probes", &render_probes);
-		}
-		ImGui::Checkbox("Show probes_text", &show_probes_text);
-		if (hdr) {
-			ImGui::SliderFloat("Average luminance", &average_lum, 0.0, 2.0);
-			ImGui::SliderFloat("White luminance", &lum_white, 0.0, 2.0);
-			ImGui::SliderFloat("Scale tonemap", &scale_tm, 0.001, 2.0);
-		}
-		ImGui::Combo("Blend", (int*)&blend_mode, "DITHERING\0FORWARD", 2);
-		ImGui::SliderFloat("Treshold intensity", &fx.treshold_intensity, 0, 10);
-		ImGui::SliderFloat("Bloom intensity", &fx.bloom_intensity, 0, 10);
-		ImGui::SliderFloat("focal intesity", &fx.focal_dist, 0, 5000);
-		ImGui::SliderFloat("min distance", &fx.min_distance, 0, 1000);
-		ImGui::SliderFloat("max distance", &fx.max_distance, 0, 1000);
-	}
-}
-
-
-void GTR::Renderer::renderGBuffers(Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera)
-{
-	glClearColor(scene->background_color.x, scene->background_color.y, scene->background_color.z, 1.0);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glEnable(GL_DEPTH_TEST);
-	checkGLErrors();
-
-	if (scene->enviroment)
-		renderSkybox(scene->enviroment, camera);
-
-	for (size_t i = 0; i < rendercalls.size(); i++)
-	{
-		renderCall& rc = rendercalls[i];
-		if (blend_mode == FORWARD_BLEND && rc.material->alpha_mode == eAlphaMode::BLEND)
-			continue;
-		renderMeshWithMaterial(eRenderMode::GBUFFERS, scene, rc.model, rc.mesh, rc.material, camera);
-	}
-}
-
-
-void GTR::Renderer::defineAndPosGridProbe(GTR::Scene* scene)
-{
-	//when computing the probes position�
-
-	//define the corners of the axis aligned grid
-	//this can be done using the boundings of our scene
-
-	//define how many probes you want per dimension -230, 36, -342 //500 433 460
-
-	//compute the vector from one corner to the other
-
-	//and scale it down according to the subdivisions
-	//we substract one to be sure the last probe is at end pos
-	irr_delta.x /= (irr_dim.x - 1);
-	irr_delta.y /= (irr_dim.y - 1);
-	irr_delta.z /= (irr_dim.z - 1);
-
-	//now delta give us the distance between probes in every axis
-
-	//lets compute the centers
-	//pay attention at the order at which we add them
-	for (int z = 0; z < irr_dim.z; ++z)
-		for (int y = 0; y < irr_dim.y; ++y)
-			for (int x = 0; x < irr_dim.x; ++x)
-			{
-				sProbe p;
-				p.local.set(x, y, z);
-
-				//index in the linear array
-				p.index = x + y * irr_dim.x + z * irr_dim.x * irr_dim.y;
-
-				//and its position
-				p.pos = irr_start_pos + irr_delta * Vector3(x, y, z);
-				probes.push_back(p);
-			}
-
-	if (!probes_texture)
-	{
-		int numProb = probes.size();
-		probes_texture = new Texture(
-			9, //9 coefficients per probe
-			numProb, //as many rows as probes
-			GL_RGB, //3 channels per coefficient
-			GL_FLOAT); //they require a high range
-	}
-}
-
-
-void Renderer::renderProbe(Vector3 pos, float size, float* coeffs)
-{
-	Camera* camera = Camera::current;
-	Shader* shader = Shader::Get("probe");
-	Mesh* mesh = Mesh::Get("data/meshes/sphere.obj");
-
-	glEnable(GL_CULL_FACE);
-	glDisable(GL_BLEND);
-	glEnable(GL_DEPTH_TEST);
-
-	Matrix44 model;
-	model.setTranslation(pos.x, pos.y, pos.z);
-	model.scale(size, size, size);
-
-	shader->enable();
-	shader->setUniform("u_viewprojection", camera->viewprojection_matrix);
-	shader->setUniform("u_camera_position", camera->eye);
-	shader->setUniform("u_model", model);
-	shader->setUniform3Array("u_coeffs", coeffs, 9);
-
-	mesh->render(GL_TRIANGLES);
-
-}
-
-
-void Renderer::extractProbe(GTR::Scene* scene, sProbe& p) {
-	FloatImage images[6]; //here we will store the six views
-	Camera cam;
-
-	//set the fov to 90 and the aspect to 1
-	cam.setPerspective(90, 1, 0.1, 1000);
-
-	if (!irr_fbo) {
-		irr_fbo = new FBO();
-		irr_fbo->create(64, 64, 1, GL_RGB, GL_FLOAT);
-	}
-
-	collectRenderCalls(scene, NULL);
-	//std::cout << renderCallList.size() << "\n";
-
-	for (int i = 0; i < 6; i++) //for every cubemap face
-	{
-		//compute camera orientation using defined vectors
-		Vector3 eye = p.pos;
-		Vector3 front = cubemapFaceNormals[i][2];
-		Vector3 center = p.pos + front;
-		Vector3 up = cubemapFaceNormals[i][1];
-		cam.lookAt(eye, center, up);
-		cam.enable();
-
-		//render the scene from this point of view
-		irr_fbo->bind();
-		renderForward(scene, renderCallList, &cam);
-		irr_fbo->unbind();
-
-		//read the pixels back and store in a FloatImage
-		images[i].fromTexture(irr_fbo->color_textures[0]);
-	}
-
-	//compute the coefficients given the six images
-	p.sh = computeSH(images, 1.0);
-}
-
-void GTR::Renderer::updateIrradianceCache(GTR::Scene* scene) {
-
-	//we must create the color information for the texture. because every SH are 27 floats in the RGB,RGB,... order, we can create an array of SphericalHarmonics and use it as pixels of the texture
-	SphericalHarmonics* sh_data = NULL;
-	sh_data = new SphericalHarmonics[ irr_dim.x * irr_dim.y * irr_dim.z ];
-
-	int numProbes = probes.size();
-	//now compute the coeffs for every probe
-	for (int iP = 0; iP < numProbes; ++iP)
-	{
-		extractProbe(scene, probes[iP]);
-		sh_data[iP] = probes[iP].sh;
-	}
-
-
-	//here we fill the data of the array with our probes in x,y,z order...
-	//now upload the data to the GPU
-	probes_texture->upload( GL_RGB, GL_FLOAT, false, (uint8*)sh_data);
-
-	////disable any texture filtering when reading
-	probes_texture->bind();
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-	////always free memory after allocating it!!!
-	delete[] sh_data;
-	//extractProbe(scene, probe);
-}
-
-Texture* GTR::CubemapFromHDRE(const char* filename)
-{
-	HDRE* hdre = HDRE::Get(filename);
-	if (!hdre)
-		return NULL;
-
-	Texture* texture = new Texture();
-	if (hdre->getFacesf(0))
-	{
-		texture->createCubemap(hdre->width, hdre->height, (Uint8**)hdre->getFacesf(0),
-			hdre->header.numChannels == 3 ? GL_RGB : GL_RGBA, GL_FLOAT);
-		for (int i = 1; i < hdre->levels; ++i)
-			texture->uploadCubemap(texture->format, texture->type, false,
-				(Uint8**)hdre->getFacesf(i), GL_RGBA32F, i);
-	}
-	else
-		if (hdre->getFacesh(0))
-		{
-			texture->createCubemap(hdre->width, hdre->height, (Uint8**)hdre->getFacesh(0),
-				hdre->header.numChannels == 3 ? GL_RGB : GL_RGBA, GL_HALF_FLOAT);
-			for (int i = 1; i < hdre->levels; ++i)
-				texture->uploadCubemap(texture->format, texture->type, false,
-					(Uint8**)hdre->getFacesh(i), GL_RGBA16F, i);
-		}
-	return texture;
-}
-
-GTR::FX::FX() {
-	treshold_intensity = 1.0f;
-	bloom_intensity = 0.63f;
-
-	focal_dist = 461;
-	min_distance = 101.0f;
-	max_distance = 189.0f;
-
-	float min_distance = 8;
-	float max_distance = 12;
-
-	w = Application::instance->window_width;;
-	h = Application::instance->window_height;;
-}
-
-void GTR::FX::blur(Texture* input, Texture* output) {
-	setFX(BLUR, input, output);
-}
-
-void GTR::FX::treshold(Texture* input, Texture* output) {
-	setFX(TRESHOLD, input, output);
-}
-
-void GTR::FX::bloom(Texture* input_base, Texture* input_blurred, Texture* output) {
-	setFX(BLOOM, input_base, output, input_blurred);
-}
-
-void GTR::FX::aa(Texture* input, Texture* output) {
-	setFX(AA, input, output);
-}
-
-void GTR::FX::dof(Texture* input, Texture* input_blurred, Texture* depth_buffer, Camera* camera, Texture* output) {
-	setFX(DOF, input, output, input_blurred, depth_buffer, camera);
-}
-
-void GTR::FX::setFX(eFxMode fx, Texture* input, Texture* output, Texture* second_input, Texture* depth_buffer, Camera* camera)
-{
-	FBO* fbo = Texture::getGlobalFBO(output);
-	fbo->bind();
-
-		Mesh* quad = Mesh::getQuad();
-		Shader* sh;
-		switch (fx) {
-			case AA: sh = Shader::Get("AAFX"); break;
-			case TRESHOLD: sh = Shader::Get("tresholdFX"); break;
-			case BLUR: sh = Shader::Get("blurFX"); break;
-			case BLOOM: sh = Shader::Get("bloomFX"); break;
-			case DOF: sh = Shader::Get("DOFFX"); break;
-		}
-
-		glDisable(GL_DEPTH_TEST);
-		glDisable(GL_BLEND);
-
-		sh->enable();
-
-			sh->setTexture("u_input", input, 9);
-
-			switch (fx) {
-				case BLUR:
-					sh->setUniform("horizontal", horizontal);
-					break;
-				case AA: 
-					sh->setUniform("u_iViewportSize", Vector2(1.0 / (float)w, 1.0 / (float)h));
-					sh->setUniform("u_viewportSize", Vector2((float)w, (float)h));
-					break;
-				case TRESHOLD:
-					sh->setUniform("u_treshold_intensity", treshold_intensity);
-					break;
-				case BLOOM: 
-					sh->setTexture("u_input_blurred", second_input, 10);
-					sh->setUniform("u_bloom_intensity", bloom_intensity);
-					break;
-				case DOF:
-					sh->setTexture("u_input_blurred", second_input, 10);
-					sh->setTexture("u_depth_buffer", depth_buffer, 11);
-
-					Matrix44 inv_vp = camera->viewprojection_matrix;
-					inv_vp.inverse();
-					sh->setUniform("u_inverse_viewprojection", inv_vp);
-					sh->setUniform("u_camera_pos", camera->eye);
-
-					sh->setUniform("u_iRes", Vector2(1.0 / (float)w, 1.0 / (float)h));
-					sh->setUniform("u_dist_of_focus", focal_dist);
-
-					sh->setUniform("u_min_distance", min_distance);
-					sh->setUniform("u_max_distance", max_distance);
-					break;
-			}
-
-			quad->render(GL_TRIANGLES);
-
-		sh->disable();
-
-	fbo->unbind();
-
-}
+#include "renderer.h"
+
+#include "camera.h"
+#include "shader.h"
+#include "mesh.h"
+#include "texture.h"
+#include "prefab.h"
+#include "material.h"
+#include "utils.h"
+#include "scene.h"
+#include "extra/hdre.h"
+#include "application.h"
+#include <algorithm>
+#include <chrono>
+#include "sphericalharmonics.h"
+#include "jobs.h"
+#include "glstate.h"
+
+using namespace GTR;
+
+//below this number of entities the threads cost more than what they save
+const int MIN_PARALLEL_ENTITIES = 16;
+const int MIN_PARALLEL_BVH_ITEMS = 256;
+
+//the blocks are copied as they are to the uniform buffers
+static_assert(sizeof(sFrameBlock) == 96, "sFrameBlock must match FrameBlock in the shader atlas");
+static_assert(sizeof(sLightBlock) == 4944, "sLightBlock must match LightBlock in the shader atlas");
+static_assert(sizeof(sMaterialData) == 48, "sMaterialData must match sMaterial in the shader atlas");
+static_assert(sizeof(sClusterBlock) == NUM_CLUSTERS * 4 + 16, "sClusterBlock must match ClusterBlock in the shader atlas");
+
+sProbe probe;
+
+Renderer::Renderer() {
+	w = Application::instance->window_width;
+	h = Application::instance->window_height;
+
+	average_lum = 1.0;
+	lum_white = 1.0;
+	scale_tm = 1.0;
+
+	render_mode = eRenderMode::DEFAULT;
+	pipeline_mode = ePipelineMode::DEFERRED;
+	blend_mode = FORWARD_BLEND;
+
+	mesh_shaders[DEFAULT][0] = Shader::getHandle(SID("multipasslight"));
+	mesh_shaders[DEFAULT][1] = Shader::getHandle(SID("multipasslight_instanced"));
+	mesh_shaders[SHOW_TEXTURE][0] = Shader::getHandle(SID("texture"));
+	mesh_shaders[SHOW_TEXTURE][1] = Shader::getHandle(SID("texture_instanced"));
+	mesh_shaders[SHOW_NORMAL][0] = Shader::getHandle(SID("normal"));
+	mesh_shaders[SHOW_NORMAL][1] = Shader::getHandle(SID("normal_instanced"));
+	mesh_shaders[SHOW_OCCLUSION][0] = Shader::getHandle(SID("occlusion"));
+	mesh_shaders[SHOW_OCCLUSION][1] = Shader::getHandle(SID("occlusion_instanced"));
+	mesh_shaders[SHOW_UVS][0] = Shader::getHandle(SID("uvs"));
+	mesh_shaders[SHOW_UVS][1] = Shader::getHandle(SID("uvs_instanced"));
+	mesh_shaders[SINGLE][0] = Shader::getHandle(SID("basiclight"));
+	mesh_shaders[SINGLE][1] = Shader::getHandle(SID("basiclight_instanced"));
+	mesh_shaders[GBUFFERS][0] = Shader::getHandle(SID("gbuffers"));
+	mesh_shaders[GBUFFERS][1] = Shader::getHandle(SID("gbuffers_instanced"));
+	mesh_shaders[CLUSTERED][0] = Shader::getHandle(SID("clustered"));
+	mesh_shaders[CLUSTERED][1] = Shader::getHandle(SID("clustered_instanced"));
+
+	sphere_mesh = Mesh::Get("data/meshes/sphere.obj");
+	cone_mesh = new Mesh();
+	cone_mesh->createCone();
+	cone_mesh->uploadToVRAM();
+
+	createScreenTargets(w, h);
+
+	if (apply_irr)
+	{
+		irr_fbo = NULL;
+
+		irr_start_pos = Vector3(-230, 36, -342);
+		irr_end_pos = Vector3(530, 433, 460);
+		irr_dim = Vector3(8, 6, 12);
+		irr_delta = (irr_end_pos - irr_start_pos);
+		irr_normal_dist = 1.0;
+
+		defineAndPosGridProbe(GTR::Scene::instance);
+	}
+}
+
+
+void Renderer::render(GTR::Scene* scene, Camera* camera) {
+
+	//the nodes edited since last frame change the version of their prefab
+	updatePrefabs(scene);
+
+	//detect the entities that changed since last frame
+	scene->updateVersions();
+
+	//views that were not rendered last frame lose their cached list (removed lights, shadow tiles that were reused)
+	for (auto it = render_caches.begin(); it != render_caches.end(); )
+	{
+		if (it->second.frame != render_frame)
+			it = render_caches.erase(it);
+		else
+			++it;
+	}
+	render_frame++;
+
+	instanced_calls = 0;
+	instanced_draws = 0;
+	multidraw_groups = 0;
+	multidraws = 0;
+
+	renderSceneShadowmaps(scene, camera);
+	updateLightBlock(scene);
+
+	if (show_fbo) {
+		if (showCameraDirectional) 
+			renderToFbo(scene, scene->lights[3]);
+		else 
+			renderToFbo(scene, scene->lights[0]);
+	}
+	else {
+		//renderToFbo(scene, camera, &fbo);
+		renderScene(scene, camera, pipeline_mode);
+		if (compare_precision)
+		{
+			comparePrecision(scene, camera);
+			compare_precision = false;
+		}
+	}
+}
+
+void Renderer::renderForward(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera) {
+
+	//set the clear color (the background color)
+	glClearColor(scene->background_color.x, scene->background_color.y, scene->background_color.z, 1.0);
+
+	// Clear the color and the depth buffer
+	//the shadow tiles are cleared by renderShadowTile, the dynamic casters are drawn over the cached static depth
+	if (!rendering_shadowmap)
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	checkGLErrors();
+
+	if (scene->enviroment) {
+		renderSkybox(scene->enviroment, camera);
+	}
+
+	updateFrameBlock(scene, camera);
+	if (use_clustered_forward && !rendering_shadowmap && (render_mode == DEFAULT || render_mode == SINGLE))
+	{
+		//every page of lights draws the scene again, adding its light to the first one
+		for (int page = 0; page < light_pages.size(); ++page)
+		{
+			useLightPage(page);
+			updateClusterBlock(scene, camera);
+			renderCallsInstanced(render_mode, scene, rendercalls, camera, false);
+		}
+		useLightPage(0);
+	}
+	else
+		renderCallsInstanced(render_mode, scene, rendercalls, camera, false);
+}
+
+void Renderer::renderDeferred(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera) {
+
+	int w = Application::instance->window_width;
+	int h = Application::instance->window_height;
+
+
+	if (gbuffers_fbo.fbo_id == 0) {
+		gbuffers_fbo.create(w, h, 3, GL_RGBA,GL_UNSIGNED_BYTE);
+		//only the albedo is attached, without a depth buffer, so the decals can read the gbuffers depth while they draw
+		decals_fbo.setColorOnly(gbuffers_fbo.color_textures[0]);
+	}
+
+	gbuffers_fbo.bind();
+
+		renderGBuffers(scene, rendercalls, camera);
+
+	gbuffers_fbo.unbind();
+
+	renderDecalls(scene, camera);
+
+	if (!ao_buffer)
+		ao_buffer = new Texture(w, h, GL_RED, GL_UNSIGNED_BYTE);
+
+	if (!ao_blur_buffer)
+		ao_blur_buffer = new Texture(w, h, GL_RED, GL_UNSIGNED_BYTE);
+
+	if (apply_ssao) {
+		ssao.apply(gbuffers_fbo.depth_texture, gbuffers_fbo.color_textures[1], camera, ao_buffer);
+		ssao.blurTexture(ao_buffer, ao_blur_buffer);
+	}
+
+	//the light lists of the tiles go first, the fbos can not be nested
+	tiled_lights_mask = use_tiled_deferred ? getTiledLightsMask(scene) : 0;
+	if (tiled_lights_mask)
+		computeLightTiles(camera, &gbuffers_fbo);
+
+	fbo.bind();	//textura final pre hdr
+	renderFinalFBO(&gbuffers_fbo, camera, scene, hdr, ao_buffer, rendercalls);
+	if (updateIrradianceOnce) { // Para que comience updateada la irradiancia
+		updateIrradianceCache(scene);
+		updateIrradianceOnce = false;
+	}
+	fbo.unbind();
+
+	//AA, bloom, DoF and tonemap, only the passes that reach the screen are executed
+	buildPostFXGraph(camera, w, h);
+	post_fx_graph.compile();
+	post_fx_graph.execute();
+
+	char config[64];
+	sprintf(config, "%dx%d %s", w, h, !hdr ? "LDR" : use_only_FXAA ? "FXAA" : use_bloom_dof ? "bloom+DoF" : "HDR");
+	size_t& peak = post_fx_peak_memory[config];
+	peak = std::max(peak, post_fx_graph.memory);
+
+	if (show_gbuffers)
+		view_gbuffers(camera);
+	else if (show_ao_buffer)
+		ao_blur_buffer->toViewport();
+	else if (show_depthfbo) {
+		Shader* depthShader = Shader::Get("depth");
+
+		depthShader->enable();
+		depthShader->setUniform(SID("u_camera_nearfar"), Vector2(camera->near_plane, camera->far_plane));
+
+		fbo.depth_texture->toViewport(depthShader);
+		depthShader->disable();
+
+		glViewport(0, 0, w, h);
+	}
+
+}
+
+void Renderer::createScreenTargets(int w, int h)
+{
+	//lit color before the tonemap, the alpha is never read
+	fbo.create(w, h, 1, GL_RGBA, GL_FLOAT, true, true, Texture::getFloatFormat(FLOAT_PACKED_COLOR)); //stencil for the light volumes
+}
+
+size_t Renderer::getScreenTargetsMemory()
+{
+	Texture* color = fbo.color_textures[0];
+	return (size_t)color->width * color->height * Texture::getBytesPerPixel(color->internal_format) + post_fx_graph.memory;
+}
+
+void Renderer::comparePrecision(GTR::Scene* scene, Camera* camera)
+{
+	int w = Application::instance->window_width;
+	int h = Application::instance->window_height;
+	bool full_precision = Texture::use_full_precision;
+
+	//the same frame with every float target in full precision and then with the formats of the policy
+	for (int i = 0; i < 2; ++i)
+	{
+		Texture::use_full_precision = i == 0;
+		createScreenTargets(w, h);
+		renderScene(scene, camera, pipeline_mode);
+		precision_pixels[i].resize(w * h * 3);
+		glReadPixels(0, 0, w, h, GL_RGB, GL_FLOAT, &precision_pixels[i][0]);
+		precision_memory[i] = getScreenTargetsMemory();
+	}
+
+	Texture::use_full_precision = full_precision;
+	if (full_precision)
+		createScreenTargets(w, h);
+
+	float max_difference = 0.0;
+	double sum = 0.0;
+	for (int i = 0; i < precision_pixels[0].size(); ++i)
+	{
+		float difference = fabs(precision_pixels[0][i] - precision_pixels[1][i]);
+		max_difference = std::max(max_difference, difference);
+		sum += difference;
+	}
+	precision_max_difference = max_difference;
+	precision_mean_difference = precision_pixels[0].size() ? sum / precision_pixels[0].size() : 0.0;
+}
+
+void Renderer::buildPostFXGraph(Camera* camera, int w, int h)
+{
+	FrameGraph& graph = post_fx_graph;
+	graph.clear();
+	fx.w = w;
+	fx.h = h;
+
+	//nothing reads the alpha of the effects, the color fits in 32 bits
+	sTargetDesc desc = { w, h, GL_RGB, GL_FLOAT, Texture::getFloatFormat(FLOAT_PACKED_COLOR) };
+	int scene_color = graph.importTexture("scene", fbo.color_textures[0]);
+	int scene_depth = graph.importTexture("depth", fbo.depth_texture);
+	int screen = graph.importTexture("screen", NULL, true);
+
+	//every write goes to a new target, the pool gives the same texture to the ones that do not overlap
+	int aa = graph.createTarget("aa", desc);
+	int dof = graph.createTarget("bloom_dof", desc);
+
+	//half float pyramid from half to 1/32 of the screen, built once for the bloom and the DoF
+	int down[FX_PYRAMID_LEVELS];
+	int up[FX_PYRAMID_LEVELS];
+	for (int i = 0; i < FX_PYRAMID_LEVELS; ++i)
+	{
+		sTargetDesc level_desc = { std::max(w >> (i + 1), 1), std::max(h >> (i + 1), 1), GL_RGB, GL_FLOAT, Texture::getFloatFormat(FLOAT_PACKED_COLOR) };
+		down[i] = graph.createTarget("down", level_desc);
+		up[i] = i == FX_PYRAMID_LEVELS - 1 ? down[i] : graph.createTarget("up", level_desc);
+	}
+
+	FX* fx = &this->fx;
+	graph.addPass("aa", { scene_color }, { aa }, [=](FrameGraph& g) {
+		fx->aa(g.getTexture(scene_color), g.getTexture(aa));
+	});
+	for (int i = 0; i < FX_PYRAMID_LEVELS; ++i)
+	{
+		int input = i ? down[i - 1] : aa;
+		int output = down[i];
+		graph.addPass("downsample", { input }, { output }, [=](FrameGraph& g) {
+			fx->downsample(g.getTexture(input), g.getTexture(output));
+		});
+	}
+	for (int i = FX_PYRAMID_LEVELS - 2; i >= 0; --i)
+	{
+		int input = up[i + 1];
+		int base = down[i];
+		int output = up[i];
+		graph.addPass("upsample", { input, base }, { output }, [=](FrameGraph& g) {
+			fx->upsample(g.getTexture(input), g.getTexture(base), g.getTexture(output));
+		});
+	}
+
+	std::vector<int> inputs = { aa, up[0], scene_depth };
+	inputs.insert(inputs.end(), down, down + FX_PYRAMID_LEVELS);
+	graph.addPass("bloom_dof", inputs, { dof }, [=](FrameGraph& g) {
+		Texture* levels[FX_PYRAMID_LEVELS];
+		for (int i = 0; i < FX_PYRAMID_LEVELS; ++i)
+			levels[i] = g.getTexture(down[i]);
+		fx->bloomDof(g.getTexture(aa), levels, g.getTexture(up[0]), g.getTexture(scene_depth), camera, g.getTexture(dof));
+	});
+
+	//the options choose what reaches the screen, the rest of the passes are culled
+	int result = scene_color;
+	if (hdr && use_only_FXAA)
+		result = aa;
+	else if (hdr && use_bloom_dof)
+		result = dof;
+
+	bool tonemap = hdr;
+	float average_lum = this->average_lum;
+	float lum_white = this->lum_white;
+	float scale_tm = this->scale_tm;
+	graph.addPass("tonemap", { result }, { screen }, [=](FrameGraph& g) {
+		GLState::disable(GL_BLEND);
+		if (!tonemap)
+		{
+			g.getTexture(result)->toViewport();
+			return;
+		}
+		Shader* final_shader = Shader::Get("tonemapper"); //este aplica tonemapper
+		final_shader->enable();
+		final_shader->setUniform(SID("u_average_lum"), average_lum);
+		final_shader->setUniform(SID("u_lumwhite2"), lum_white * lum_white);
+		final_shader->setUniform(SID("u_scale"), scale_tm);
+		g.getTexture(result)->toViewport(final_shader);
+		final_shader->disable();
+	});
+}
+
+void Renderer::renderSkybox(Texture* skybox, Camera* camera)
+{
+	Mesh* mesh = sphere_mesh;
+	Shader* shader = Shader::Get("skybox");
+	shader->enable();
+
+	Matrix44 m;
+	m.translate(camera->eye.x, camera->eye.y, camera->eye.z);
+	m.scale(5, 5, 5);
+
+	shader->setUniform(SID("u_model"), m);
+	shader->setUniform(SID("u_viewprojection"), camera->viewprojection_matrix);
+	shader->setUniform(SID("u_camera_pos"), camera->eye);
+
+	shader->setTexture(SID("u_enviroment_texture"), skybox, 0);
+
+	GLState::disable(GL_BLEND);
+	GLState::disable(GL_CULL_FACE);
+	GLState::disable(GL_DEPTH_TEST);
+
+	mesh->render(GL_TRIANGLES);
+
+	GLState::enable(GL_CULL_FACE);
+	GLState::enable(GL_DEPTH_TEST);
+}
+
+void Renderer::renderFinalFBO(FBO* gbuffers_fbo, Camera* camera, GTR::Scene* scene, bool hdr, Texture* ao_buffer, std::vector <renderCall>& rendercalls) {
+
+	glClearColor(0, 0, 0, 0);
+	glClearStencil(0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	checkGLErrors();
+
+	GLState::disable(GL_BLEND);
+	GLState::disable(GL_DEPTH_TEST);
+
+	Mesh* mesh;
+	Shader* shader;
+
+	Mesh* sphere = sphere_mesh;
+	Mesh* quad = Mesh::getQuad();
+
+	gbuffers_fbo->depth_texture->copyTo(NULL);
+
+	bool first_iter = true;
+	num_light_passes = 0;
+	num_volume_passes = 0;
+
+	//every pixel is shaded once with all the lights of its tile
+	if (tiled_lights_mask)
+	{
+		shader = Shader::Get("deferred");
+		shader->enable();
+		setDeferredUniforms(camera, scene, ao_buffer, shader, hdr, gbuffers_fbo, true);
+		shader->setUniform(SID("u_tiled"), true);
+		shader->setTexture(SID("u_tile_lights"), light_tiles_fbo.color_textures[0], 8);
+		shader->setUniform(SID("u_tile_size"), LIGHT_TILE_SIZE);
+		shader->setUniform(SID("u_last_iter"), false);
+
+		GLState::enable(GL_BLEND);
+		GLState::blendFunc(GL_ONE, GL_ONE);
+		quad->render(GL_TRIANGLES);
+		shader->disable();
+		first_iter = false;
+	}
+
+	//the remaining lights (all of them without tiles, the ones out of the first page of the light block) need one pass each
+	for (size_t i = 0; i < scene->lights.size(); i++) {
+
+		LightEntity* light = scene->lights[i];
+		if (light->block_page == 0 && (tiled_lights_mask & (1u << light->block_index)))
+			continue;
+		useLightPage(light->block_page);
+
+		//the first pass also adds the ambient and emissive, so it has to cover the whole screen
+		Matrix44 volume_model;
+		Mesh* volume = NULL;
+		if (use_light_volumes && !first_iter && light->light_type != DIRECTIONAL)
+			volume = getLightVolume(light, volume_model);
+
+		if (volume)
+		{
+			markLightVolume(volume, volume_model, camera);
+			shader = Shader::Get("deferred_sphere");
+			mesh = volume;
+		}
+		else
+		{
+			shader = Shader::Get("deferred");
+			mesh = quad;
+		}
+		shader->enable();
+		bool last_iter = (i == scene->lights.size()-1);
+
+		setUniformsLight(light, camera, scene, ao_buffer, shader, hdr, gbuffers_fbo, first_iter);
+		shader->setUniform(SID("u_tiled"), false);
+		//not read, but the unsigned sampler can not share unit 0 with the others
+		shader->setUniform(SID("u_tile_lights"), 8);
+		shader->setUniform(SID("u_last_iter"), last_iter);
+		first_iter = false;
+		num_light_passes++;
+
+		GLState::enable(GL_BLEND);
+		GLState::blendFunc(GL_ONE, GL_ONE);
+
+		if (volume)
+		{
+			//back faces so it still works with the camera inside, the stencil is cleared as the pixels are shaded
+			shader->setUniform(SID("u_model"), volume_model);
+			glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+			glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+			GLState::disable(GL_DEPTH_TEST);
+			GLState::enable(GL_CULL_FACE);
+			GLState::cullFace(GL_FRONT);
+			mesh->render(GL_TRIANGLES);
+			GLState::cullFace(GL_BACK);
+			GLState::disable(GL_CULL_FACE);
+			glDisable(GL_STENCIL_TEST);
+			num_volume_passes++;
+		}
+		else
+			mesh->render(GL_TRIANGLES);
+
+		shader->disable();
+	}
+	useLightPage(0);
+
+	if (blend_mode == FORWARD_BLEND) {
+		GLState::enable(GL_BLEND);
+		GLState::enable(GL_DEPTH_TEST);
+		updateFrameBlock(scene, camera);
+		int num_pages = use_clustered_forward ? (int)light_pages.size() : 1;
+		for (int page = 0; page < num_pages; ++page)
+		{
+			useLightPage(page);
+			if (use_clustered_forward)
+				updateClusterBlock(scene, camera);
+			for (size_t i = 0; i < rendercalls.size(); i++)
+			{
+				renderCall& rc = rendercalls[i];
+				if (rc.material->alpha_mode != eAlphaMode::BLEND) continue;
+				renderMeshWithMaterial(eRenderMode::SINGLE, scene, rc.model, rc.mesh, rc.material, camera, rc.lod);
+			}
+		}
+		useLightPage(0);
+		if (Shader::current)
+			Shader::current->disable();
+
+	}
+
+	GLState::disable(GL_BLEND);
+	GLState::disable(GL_DEPTH_TEST);
+	
+	if (use_volumetric)
+		computeVolumetric(camera, gbuffers_fbo->depth_texture, scene);
+
+	int numProbes = probes.size();
+	//now compute the coeffs for every probe
+	if (render_probes)
+	{
+		for (int iP = 0; iP < numProbes; ++iP) {
+			int probe_index = iP;
+			renderProbe(probes[iP].pos, 3.0, probes[iP].sh.coeffs[0].v);
+		}
+	}
+
+	if (irr_fbo && show_irr_fbo) {
+		irr_fbo->color_textures[0]->toViewport();
+	}
+	if (show_probes_text && probes_texture) {
+		probes_texture->toViewport();
+	}
+
+}
+
+void Renderer::view_gbuffers(Camera* camera) {
+
+	FBO* fbo = &gbuffers_fbo;
+
+	glViewport(0, h * 0.5, w * 0.5, h * 0.5);
+	fbo->color_textures[0]->toViewport();
+	glViewport(w * 0.5, h * 0.5, w * 0.5, h * 0.5);
+	fbo->color_textures[1]->toViewport();
+	glViewport(0, 0, w * 0.5, h * 0.5);
+	fbo->color_textures[2]->toViewport();
+	glViewport(w * 0.5, 0, w * 0.5, h * 0.5);
+
+	Shader* depthShader = Shader::Get("depth");
+
+	depthShader->enable();
+	depthShader->setUniform(SID("u_camera_nearfar"), Vector2(camera->near_plane, camera->far_plane));
+
+	fbo->depth_texture->toViewport(depthShader);
+	depthShader->disable();
+
+	glViewport(0, 0, w, h);
+}
+
+void Renderer::computeVolumetric(Camera* camera, Texture* depth_texture, Scene* scene) {
+	// Volumetric rendering
+
+	//scattering of the directional light with shadows, through its cascades when it has them
+	LightEntity* light = cascade_light && cascade_light->fbo ? cascade_light : NULL;
+	for (int i = 0; i < scene->lights.size() && !light; ++i)
+		if (scene->lights[i]->light_type == DIRECTIONAL && scene->lights[i]->fbo && scene->lights[i]->cast_shadows)
+			light = scene->lights[i];
+	if (!light)
+		return;
+	useLightPage(light->block_page);
+
+	Mesh* quad_volum = Mesh::getQuad();
+	Shader* sh = Shader::Get("volume_direct");
+	sh->enable();
+
+	Matrix44 inv_vp = camera->viewprojection_matrix;
+	inv_vp.inverse();
+
+	sh->setUniform(SID("u_inverse_viewprojection"), inv_vp);
+	sh->setTexture(SID("u_depth_texture"), depth_texture, 3);
+	sh->setUniform(SID("u_camera_pos"), camera->eye);
+
+	light->setLightUniforms(sh, true);
+
+	GLState::enable(GL_BLEND);
+	GLState::blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::disable(GL_DEPTH_TEST);
+
+	quad_volum->render(GL_TRIANGLES);
+	GLState::disable(GL_BLEND);
+
+	sh->disable();
+	useLightPage(0);
+}
+
+void Renderer::setUniformsLight(LightEntity* light, Camera* camera, GTR::Scene* scene, Texture* ao_buffer, Shader* shader, bool hdr, FBO* gbuffers_fbo, bool first_iter) {
+
+	setDeferredUniforms(camera, scene, ao_buffer, shader, hdr, gbuffers_fbo, first_iter);
+
+	if (light->light_type == eLightType(0))
+		light->setLightUniforms(shader, false);
+	else
+		light->setLightUniforms(shader, true);
+}
+
+void Renderer::setDeferredUniforms(Camera* camera, GTR::Scene* scene, Texture* ao_buffer, Shader* shader, bool hdr, FBO* gbuffers_fbo, bool first_iter) {
+
+	shader->setUniform(SID("u_viewprojection"), camera->viewprojection_matrix);
+
+	Matrix44 inv_vp = camera->viewprojection_matrix;
+	inv_vp.inverse();
+
+	shader->setUniform(SID("hdr"), hdr);
+
+	shader->setUniform(SID("u_camera_position"), camera->eye);
+	shader->setUniform(SID("u_inverse_viewprojection"), inv_vp);
+
+	shader->setTexture(SID("u_color_texture"), gbuffers_fbo->color_textures[0], 0);
+
+	shader->setTexture(SID("u_normal_texture"), gbuffers_fbo->color_textures[1], 1);
+	shader->setTexture(SID("u_extra_texture"), gbuffers_fbo->color_textures[2], 2);
+	shader->setTexture(SID("u_depth_texture"), gbuffers_fbo->depth_texture, 3);
+	if (shadow_atlas.fbo.depth_texture)
+		shader->setTexture(SID("u_shadowmap"), shadow_atlas.fbo.depth_texture, 20);
+	shader->setUniform(SID("u_iRes"), Vector2(1.0 / (float)gbuffers_fbo->width, 1.0 / (float)gbuffers_fbo->height));
+
+	if (first_iter)
+		shader->setUniform(SID("u_ambient_light"), scene->ambient_light);
+	else 
+		shader->setUniform(SID("u_ambient_light"), Vector3());
+
+	shader->setUniform(SID("u_first_iter"), first_iter);
+
+	if (apply_ssao)
+		shader->setTexture(SID("u_ao_texture"), ao_buffer, 5);
+
+	shader->setUniform(SID("u_apply_ssao"), apply_ssao);
+
+	shader->setUniform(SID("u_apply_irr"), apply_irr);
+	shader->setUniform(SID("u_tri_irr"), apply_tri_irr);
+	shader->setUniform(SID("u_num_probes"), (float)probes.size());
+	shader->setUniform(SID("u_irr_start"), irr_start_pos);
+	shader->setUniform(SID("u_irr_end"), irr_end_pos);
+	shader->setUniform(SID("u_irr_dims"), irr_dim);
+	shader->setUniform(SID("u_irr_delta"), irr_delta);
+	shader->setUniform(SID("u_irr_normal_dist"), irr_normal_dist);
+	shader->setUniform(SID("u_probes_texture"), probes_texture, 6);
+	shader->setTexture(SID("u_enviroment_texture"), scene->enviroment, 7);
+	shader->setUniform(SID("u_use_reflections"), use_reflections);
+}
+
+Mesh* Renderer::getLightVolume(LightEntity* light, Matrix44& model)
+{
+	//a bit bigger so the faceted proxy contains the whole attenuation range
+	float range = light->max_distance * 1.1;
+	if (range <= 0.0)
+		return NULL;
+
+	Vector3 position = light->model.getTranslation();
+
+	//very wide cones are closer to a sphere than to the proxy
+	if (light->light_type == POINT || light->cone_angle >= 80.0)
+	{
+		model.setScale(range, range, range);
+		model.translateGlobal(position.x, position.y, position.z);
+		return sphere_mesh;
+	}
+
+	float radius = range * tan((light->cone_angle / 180.0) * PI);
+	Vector3 right = light->model.rightVector();
+	Vector3 top = light->model.topVector();
+	Vector3 front = light->model.frontVector();
+	right.normalize();
+	top.normalize();
+	front.normalize();
+
+	model.setIdentity();
+	model.m[0] = right.x * radius; model.m[1] = right.y * radius; model.m[2] = right.z * radius;
+	model.m[4] = top.x * radius; model.m[5] = top.y * radius; model.m[6] = top.z * radius;
+	model.m[8] = front.x * range; model.m[9] = front.y * range; model.m[10] = front.z * range;
+	model.m[12] = position.x; model.m[13] = position.y; model.m[14] = position.z;
+	return cone_mesh;
+}
+
+void Renderer::markLightVolume(Mesh* volume, const Matrix44& model, Camera* camera)
+{
+	//faces hidden by the scene change the counter, a pixel ends up non zero if its geometry is between the front and back faces
+	Shader* shader = Shader::Get("flat");
+	shader->enable();
+	shader->setUniform(SID("u_viewprojection"), camera->viewprojection_matrix);
+	shader->setUniform(SID("u_model"), model);
+	shader->setUniform(SID("u_color"), Vector4(0, 0, 0, 0));
+
+	glColorMask(false, false, false, false);
+	GLState::depthMask(false);
+	GLState::enable(GL_DEPTH_TEST);
+	GLState::depthFunc(GL_LESS);
+	GLState::disable(GL_CULL_FACE);
+	GLState::disable(GL_BLEND);
+
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_ALWAYS, 0, 0);
+	glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+	glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+
+	volume->render(GL_TRIANGLES);
+
+	glColorMask(true, true, true, true);
+	GLState::depthMask(true);
+	shader->disable();
+}
+
+unsigned int Renderer::getTiledLightsMask(GTR::Scene* scene)
+{
+	unsigned int mask = 0;
+	for (int i = 0; i < scene->lights.size(); ++i)
+	{
+		LightEntity* light = scene->lights[i];
+		//the tiles only store the lights of the first page, the rest get their own pass
+		if (light->block_page != 0)
+			continue;
+		//the shadowmaps are in the atlas, so any light can be shaded with the others
+		mask |= 1u << light->block_index;
+	}
+	return mask;
+}
+
+void Renderer::computeLightTiles(Camera* camera, FBO* gbuffers_fbo)
+{
+	int tiles_x = (gbuffers_fbo->width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+	int tiles_y = (gbuffers_fbo->height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+
+	if (light_tiles_fbo.width != tiles_x || light_tiles_fbo.height != tiles_y)
+	{
+		light_tiles_fbo.freeTextures();
+		Texture* tiles = new Texture(tiles_x, tiles_y, GL_RED_INTEGER, GL_UNSIGNED_INT, false, NULL, GL_R32UI);
+		//integer textures can not be filtered
+		GLState::bindTexture(tiles->texture_type, tiles->texture_id);
+		glTexParameteri(tiles->texture_type, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(tiles->texture_type, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		light_tiles_fbo.setTexture(tiles);
+		light_tiles_fbo.owns_textures = true;
+	}
+
+	Matrix44 inv_vp = camera->viewprojection_matrix;
+	inv_vp.inverse();
+
+	light_tiles_fbo.bind();
+	GLState::disable(GL_BLEND);
+	GLState::disable(GL_DEPTH_TEST);
+
+	Shader* shader = Shader::Get("tileLights");
+	shader->enable();
+	shader->setTexture(SID("u_depth_texture"), gbuffers_fbo->depth_texture, 3);
+	shader->setUniform(SID("u_inverse_viewprojection"), inv_vp);
+	shader->setUniform(SID("u_tiled_lights_mask"), (int)tiled_lights_mask);
+	shader->setUniform(SID("u_tile_size"), LIGHT_TILE_SIZE);
+	Mesh::getQuad()->render(GL_TRIANGLES);
+	shader->disable();
+
+	light_tiles_fbo.unbind();
+}
+
+void Renderer::renderToFbo(GTR::Scene* scene, LightEntity* light) {
+
+
+	Shader* shader = Shader::Get("depth");
+
+	shader->enable();
+	GLState::disable(GL_DEPTH_TEST);
+
+	shader->setUniform(SID("u_camera_nearfar"), Vector2(light->camera.near_plane, light->camera.far_plane));
+
+	//the whole atlas, the tiles of all the lights
+	if (light->fbo)
+		light->fbo->depth_texture->toViewport(shader);
+
+	GLState::enable(GL_DEPTH_TEST);
+	shader->disable();
+}
+
+void Renderer::collectRenderCalls(GTR::Scene* scene, Camera* camera) {
+
+	renderCallList.clear();
+
+	if (camera && use_bvh)
+		collectRenderCallsBVH(scene, camera);
+	else if (use_parallel_collect && scene->entities.size() >= MIN_PARALLEL_ENTITIES)
+		collectRenderCallsParallel(scene, camera);
+	else
+		collectRenderCallsCompiled(scene, camera);
+
+	if (camera)
+		sortRenderCalls(camera);
+}
+
+//bits of the key, from the most significant:
+//opaque and masked: alpha mode (2) | two sided (1) | material (16) | mesh (16) | depth (24) front to back
+//blended: alpha mode (2) | inverted depth (24) back to front | material (16) | mesh (16)
+//the shader is chosen by the render mode so it is the same for the whole list
+uint64_t Renderer::computeSortKey(const renderCall& rc, Camera* camera)
+{
+	const uint64_t max_depth = (1 << 24) - 1;
+
+	float depth = rc.distance_to_cam / camera->far_plane;
+	depth = clamp(depth, 0.0f, 1.0f);
+	uint64_t quantized_depth = (uint64_t)(depth * max_depth);
+
+	uint64_t alpha = (uint64_t)rc.material->alpha_mode;
+	uint64_t material_id = (uint64_t)rc.material->id & 0xFFFF;
+	uint64_t mesh_id = (uint64_t)rc.mesh->id & 0xFFFF;
+
+	if (rc.material->alpha_mode == BLEND)
+		return (alpha << 62) | ((max_depth - quantized_depth) << 32) | (material_id << 16) | mesh_id;
+
+	uint64_t two_sided = rc.material->two_sided ? 1 : 0;
+	return (alpha << 62) | (two_sided << 61) | (material_id << 40) | (mesh_id << 24) | quantized_depth;
+}
+
+void Renderer::sortRenderCalls(Camera* camera)
+{
+	if (!use_radix_sort)
+	{
+		std::sort(renderCallList.begin(), renderCallList.end(), compareNodes);
+		return;
+	}
+
+	//only the keys are sorted, the calls are moved once at the end
+	render_keys.resize(renderCallList.size());
+	for (int i = 0; i < renderCallList.size(); ++i)
+	{
+		render_keys[i].key = computeSortKey(renderCallList[i], camera);
+		render_keys[i].index = i;
+	}
+
+	radixSortKeys(render_keys, render_keys_temp);
+
+	sorted_calls.resize(renderCallList.size());
+	for (int i = 0; i < render_keys.size(); ++i)
+		sorted_calls[i] = renderCallList[render_keys[i].index];
+	renderCallList.swap(sorted_calls);
+}
+
+void Renderer::benchmarkSort(Camera* camera, int iterations) {
+
+	typedef std::chrono::high_resolution_clock clock;
+
+	std::vector<renderCall> original = renderCallList;
+	bool old_use_radix_sort = use_radix_sort;
+
+	use_radix_sort = false;
+	clock::time_point start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		renderCallList = original;
+		sortRenderCalls(camera);
+	}
+	double std_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+
+	use_radix_sort = true;
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		renderCallList = original;
+		sortRenderCalls(camera);
+	}
+	double radix_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+
+	//the copy of the list is included in both times
+	std::cout << "Sort benchmark (" << original.size() << " calls, " << iterations << " iterations)" << std::endl;
+	std::cout << "\t std::sort: " << std_time << " ms" << std::endl;
+	std::cout << "\t radix: " << radix_time << " ms" << std::endl;
+
+	use_radix_sort = old_use_radix_sort;
+	renderCallList = original;
+	sortRenderCalls(camera);
+}
+
+void Renderer::collectRenderCallsCompiled(GTR::Scene* scene, Camera* camera) {
+
+	//render entities
+	for (int i = 0; i < scene->entities.size(); ++i)
+		collectEntityRenderCalls(scene->entities[i], camera, collect_buffers, renderCallList);
+}
+
+int Renderer::processEntities(GTR::Scene* scene, const std::function<void(int, sCollectBuffers&)>& func) {
+
+	JobSystem* jobs = JobSystem::get();
+	int num_entities = scene->entities.size();
+
+	//compiling from the workers is not safe
+	updatePrefabs(scene);
+
+	//every task takes a contiguous range of entities, several per thread to balance the work
+	int num_tasks = std::min(num_entities, jobs->getNumThreads() * 4);
+	if (collect_tasks.size() < num_tasks)
+		collect_tasks.resize(num_tasks);
+
+	jobs->parallelFor(num_tasks, [this, &func, num_entities, num_tasks](int task) {
+		int start = (int)((long long)num_entities * task / num_tasks);
+		int end = (int)((long long)num_entities * (task + 1) / num_tasks);
+		sCollectBuffers& buffers = collect_tasks[task];
+		buffers.calls.clear();
+		for (int i = start; i < end; ++i)
+			func(i, buffers);
+	});
+
+	return num_tasks;
+}
+
+void Renderer::updatePrefabs(GTR::Scene* scene) {
+
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (ent->entity_type != PREFAB || !((PrefabEntity*)ent)->prefab)
+			continue;
+		Prefab* prefab = ((PrefabEntity*)ent)->prefab;
+		if (!prefab->compiled.nodes.size())
+			prefab->compile();
+		else
+			prefab->compiled.update();
+	}
+}
+
+void Renderer::collectRenderCallsParallel(GTR::Scene* scene, Camera* camera) {
+
+	int num_tasks = processEntities(scene, [this, scene, camera](int i, sCollectBuffers& buffers) {
+		collectEntityRenderCalls(scene->entities[i], camera, buffers, buffers.calls);
+	});
+
+	//merge in task order so the list is the same as the serial one
+	int total = renderCallList.size();
+	for (int i = 0; i < num_tasks; ++i)
+		total += collect_tasks[i].calls.size();
+	renderCallList.reserve(total);
+	for (int i = 0; i < num_tasks; ++i)
+		renderCallList.insert(renderCallList.end(), collect_tasks[i].calls.begin(), collect_tasks[i].calls.end());
+}
+
+std::vector<renderCall>& Renderer::getCachedRenderCalls(GTR::Scene* scene, Camera* camera) {
+
+	RenderListCache& cache = render_caches[camera];
+	cache.frame = render_frame;
+	return cache.update(this, scene, camera);
+}
+
+GTR::RenderListCache::RenderListCache()
+{
+	material_version = 0;
+	valid = false;
+	frame = 0;
+	num_evaluated = 0;
+	rebuilt = false;
+}
+
+std::vector<renderCall>& GTR::RenderListCache::update(Renderer* renderer, Scene* scene, Camera* camera)
+{
+	num_evaluated = 0;
+	rebuilt = false;
+
+	//a different view or material sorting changes every key
+	if (!valid || entities.size() != scene->entities.size() || material_version != Material::sort_version ||
+		memcmp(viewprojection.m, camera->viewprojection_matrix.m, sizeof(Matrix44)) != 0)
+	{
+		rebuild(renderer, scene, camera);
+		return calls;
+	}
+
+	changed.clear();
+	for (int i = 0; i < entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (entities[i].entity != ent || entities[i].version != ent->version)
+			changed.push_back(i);
+	}
+
+	//nothing changed, the list of the last frame is still valid
+	if (!changed.size())
+		return calls;
+
+	//with most of the entities changed it is faster to start again
+	if (changed.size() * 2 > entities.size())
+		rebuild(renderer, scene, camera);
+	else
+		updateChanged(renderer, scene, camera);
+	return calls;
+}
+
+void GTR::RenderListCache::rebuild(Renderer* renderer, Scene* scene, Camera* camera)
+{
+	valid = true;
+	rebuilt = true;
+	viewprojection = camera->viewprojection_matrix;
+	material_version = Material::sort_version;
+
+	int num_entities = scene->entities.size();
+	entities.resize(num_entities);
+	for (int i = 0; i < num_entities; ++i)
+	{
+		entities[i].entity = scene->entities[i];
+		entities[i].version = scene->entities[i]->version;
+		entities[i].calls.clear();
+	}
+	num_evaluated = num_entities;
+
+	if (renderer->use_bvh)
+	{
+		//the bvh only visits the visible subtrees, its items know their entity
+		int num_tasks = renderer->cullBVH(scene, camera);
+		for (int i = 0; i < num_tasks; ++i)
+		{
+			const std::vector<int>& visible = renderer->bvh_tasks[i].visible;
+			const std::vector<renderCall>& calls = renderer->collect_tasks[i].calls;
+			for (int j = 0; j < visible.size(); ++j)
+				entities[renderer->bvh.items[visible[j]].entity_index].calls.push_back(calls[j]);
+		}
+	}
+	else if (renderer->use_parallel_collect && num_entities >= MIN_PARALLEL_ENTITIES)
+	{
+		//every entity writes in its own list so there is nothing to merge
+		renderer->processEntities(scene, [this, renderer, scene, camera](int i, sCollectBuffers& buffers) {
+			renderer->collectEntityRenderCalls(scene->entities[i], camera, buffers, entities[i].calls);
+		});
+	}
+	else
+	{
+		for (int i = 0; i < num_entities; ++i)
+			renderer->collectEntityRenderCalls(scene->entities[i], camera, renderer->collect_buffers, entities[i].calls);
+	}
+
+	refs.clear();
+	keys.clear();
+	for (int i = 0; i < num_entities; ++i)
+		addEntityKeys(renderer, i, camera, keys);
+	radixSortKeys(keys, temp_keys);
+
+	gatherCalls();
+}
+
+void GTR::RenderListCache::updateChanged(Renderer* renderer, Scene* scene, Camera* camera)
+{
+	dirty.assign(entities.size(), 0);
+	for (int i = 0; i < changed.size(); ++i)
+	{
+		int index = changed[i];
+		sCachedEntity& cached = entities[index];
+		cached.entity = scene->entities[index];
+		cached.version = cached.entity->version;
+		cached.calls.clear();
+		renderer->collectEntityRenderCalls(cached.entity, camera, renderer->collect_buffers, cached.calls);
+		dirty[index] = 1;
+	}
+	num_evaluated = changed.size();
+
+	//remove the old keys of the changed entities, the rest is still sorted
+	int num_keys = 0;
+	for (int i = 0; i < keys.size(); ++i)
+		if (!dirty[refs[keys[i].index].entity])
+			keys[num_keys++] = keys[i];
+	keys.resize(num_keys);
+
+	//sort only the new keys and merge them with the old ones
+	new_keys.clear();
+	for (int i = 0; i < changed.size(); ++i)
+		addEntityKeys(renderer, changed[i], camera, new_keys);
+	radixSortKeys(new_keys, temp_keys);
+
+	merged_keys.resize(keys.size() + new_keys.size());
+	std::merge(keys.begin(), keys.end(), new_keys.begin(), new_keys.end(), merged_keys.begin(),
+		[](const sRenderKey& a, const sRenderKey& b) { return a.key < b.key; });
+	keys.swap(merged_keys);
+
+	//the refs of the removed keys are never used again, compact them before they pile up
+	if (refs.size() > keys.size() * 2 + 1024)
+	{
+		std::vector<sCallRef> compacted(keys.size());
+		for (int i = 0; i < keys.size(); ++i)
+		{
+			compacted[i] = refs[keys[i].index];
+			keys[i].index = i;
+		}
+		refs.swap(compacted);
+	}
+
+	gatherCalls();
+}
+
+void GTR::RenderListCache::addEntityKeys(Renderer* renderer, int entity_index, Camera* camera, std::vector<sRenderKey>& output)
+{
+	std::vector<renderCall>& entity_calls = entities[entity_index].calls;
+	for (int i = 0; i < entity_calls.size(); ++i)
+	{
+		sCallRef ref;
+		ref.entity = entity_index;
+		ref.call = i;
+
+		sRenderKey key;
+		key.key = renderer->computeSortKey(entity_calls[i], camera);
+		key.index = refs.size();
+		refs.push_back(ref);
+		output.push_back(key);
+	}
+}
+
+void GTR::RenderListCache::gatherCalls()
+{
+	calls.resize(keys.size());
+	for (int i = 0; i < keys.size(); ++i)
+	{
+		const sCallRef& ref = refs[keys[i].index];
+		calls[i] = entities[ref.entity].calls[ref.call];
+	}
+}
+
+void Renderer::collectEntityRenderCalls(BaseEntity* ent, Camera* camera, sCollectBuffers& buffers, std::vector<renderCall>& output) {
+
+	if (!ent->visible)
+		return;
+
+	//is a prefab!
+	if (ent->entity_type == PREFAB)
+	{
+		PrefabEntity* pent = (GTR::PrefabEntity*)ent;
+		if (pent->prefab)
+			getRenderCallsFromPrefabs(ent, pent->prefab, camera, buffers, output);
+	}
+}
+
+void Renderer::collectRenderCallsRecursive(GTR::Scene* scene, Camera* camera) {
+
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (!ent->visible || ent->entity_type != PREFAB)
+			continue;
+
+		PrefabEntity* pent = (GTR::PrefabEntity*)ent;
+		if (pent->prefab)
+			getRenderCallsFromNode(ent, &pent->prefab->root, camera);
+	}
+}
+
+void Renderer::collectRenderCallsBVH(GTR::Scene* scene, Camera* camera) {
+
+	int num_tasks = cullBVH(scene, camera);
+
+	//merge in task order, the subtrees are in tree order so the list does not depend on the threads
+	int total = renderCallList.size();
+	for (int i = 0; i < num_tasks; ++i)
+		total += collect_tasks[i].calls.size();
+	renderCallList.reserve(total);
+	for (int i = 0; i < num_tasks; ++i)
+		renderCallList.insert(renderCallList.end(), collect_tasks[i].calls.begin(), collect_tasks[i].calls.end());
+}
+
+int Renderer::cullBVH(GTR::Scene* scene, Camera* camera) {
+
+	//refits the entities that moved since last frame
+	bvh.update(scene);
+
+	int num_tasks = 1;
+	if (use_parallel_collect && bvh.items.size() >= MIN_PARALLEL_BVH_ITEMS)
+		num_tasks = JobSystem::get()->getNumThreads() * 4;
+	bvh.getSubtrees(num_tasks, bvh_roots);
+	num_tasks = bvh_roots.size();
+	if (bvh_tasks.size() < num_tasks)
+		bvh_tasks.resize(num_tasks);
+	if (collect_tasks.size() < num_tasks)
+		collect_tasks.resize(num_tasks);
+
+	auto cullTask = [this, scene, camera](int task) {
+		SceneBVH::sCullScratch& scratch = bvh_tasks[task];
+		bvh.cullSubtree(bvh_roots[task], camera, scene, scratch);
+
+		std::vector<renderCall>& calls = collect_tasks[task].calls;
+		calls.clear();
+		for (int i = 0; i < scratch.visible.size(); ++i)
+		{
+			const sBVHItem& item = bvh.items[scratch.visible[i]];
+
+			renderCall aux;
+			aux.model = item.model;
+			aux.mesh = item.mesh;
+			aux.material = item.material;
+			aux.world_bounding = item.world_bounding;
+			aux.entity = scene->entities[item.entity_index];
+			aux.distance_to_cam = camera->eye.distance(item.world_bounding.center);
+			aux.lod = selectLOD(item.mesh, item.model, item.world_bounding, camera);
+			calls.push_back(aux);
+		}
+	};
+
+	if (num_tasks > 1)
+		JobSystem::get()->parallelFor(num_tasks, cullTask);
+	else if (num_tasks == 1)
+		cullTask(0);
+
+	bvh.num_tested = bvh.num_visible = bvh.num_accepted = 0;
+	for (int i = 0; i < num_tasks; ++i)
+	{
+		bvh.num_tested += bvh_tasks[i].num_tested;
+		bvh.num_visible += bvh_tasks[i].visible.size();
+		bvh.num_accepted += bvh_tasks[i].num_accepted;
+	}
+	return num_tasks;
+}
+
+void Renderer::benchmarkCulling(GTR::Scene* scene, Camera* camera, int iterations) {
+
+	typedef std::chrono::high_resolution_clock clock;
+
+	bvh.update(scene);
+
+	clock::time_point start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		renderCallList.clear();
+		collectRenderCallsRecursive(scene, camera);
+	}
+	double recursive_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+	int recursive_calls = renderCallList.size();
+
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		renderCallList.clear();
+		collectRenderCallsCompiled(scene, camera);
+	}
+	double compiled_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+	int compiled_calls = renderCallList.size();
+
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		renderCallList.clear();
+		collectRenderCallsParallel(scene, camera);
+	}
+	double parallel_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+	int parallel_calls = renderCallList.size();
+
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		renderCallList.clear();
+		collectRenderCallsBVH(scene, camera);
+	}
+	double bvh_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+	int bvh_calls = renderCallList.size();
+
+	std::cout << "Culling benchmark (" << bvh.items.size() << " nodes, " << iterations << " iterations)" << std::endl;
+	std::cout << "\t node tree: " << recursive_time << " ms, " << recursive_calls << " calls" << std::endl;
+	std::cout << "\t compiled: " << compiled_time << " ms, " << compiled_calls << " calls" << std::endl;
+	std::cout << "\t compiled parallel (" << JobSystem::get()->getNumThreads() << " threads): " << parallel_time << " ms, " << parallel_calls << " calls" << std::endl;
+	std::cout << "\t bvh: " << bvh_time << " ms, " << bvh_calls << " calls, " << bvh.num_tested << " boxes tested, " << bvh.num_accepted << " accepted by inner nodes" << std::endl;
+
+	//leave the list as it would be for this frame
+	collectRenderCalls(scene, camera);
+}
+
+void Renderer::benchmarkFrustumTest(GTR::Scene* scene, Camera* camera, int iterations) {
+
+	typedef std::chrono::high_resolution_clock clock;
+
+	//use the world boxes of every node in the scene
+	bvh.update(scene);
+	BoxArraySoA boxes;
+	for (int i = 0; i < bvh.items.size(); ++i)
+		boxes.add(bvh.items[i].world_bounding);
+	if (!boxes.size())
+		return;
+	std::vector<unsigned char> mask(boxes.size());
+
+	clock::time_point start = clock::now();
+	int scalar_visible = 0;
+	for (int i = 0; i < iterations; ++i)
+	{
+		scalar_visible = 0;
+		for (int j = 0; j < boxes.size(); ++j)
+			if (camera->testBoxInFrustum(Vector3(boxes.cx[j], boxes.cy[j], boxes.cz[j]), Vector3(boxes.hx[j], boxes.hy[j], boxes.hz[j])) != CLIP_OUTSIDE)
+				scalar_visible++;
+	}
+	double scalar_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+
+	std::cout << "Frustum test benchmark (" << boxes.size() << " boxes, " << iterations << " iterations)" << std::endl;
+	std::cout << "\t testBoxInFrustum: " << scalar_time << " ms, " << scalar_visible << " visible" << std::endl;
+
+	for (int level = SIMD_SCALAR; level <= getSIMDLevel(); ++level)
+	{
+		int visible = 0;
+		start = clock::now();
+		for (int i = 0; i < iterations; ++i)
+			visible = testBoxesInFrustum(camera->frustum, boxes, &mask[0], (eSIMDLevel)level);
+		double time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+		std::cout << "\t batch " << getSIMDLevelName((eSIMDLevel)level) << ": " << time << " ms, " << visible << " visible" << std::endl;
+	}
+}
+
+
+void Renderer::renderScene(GTR::Scene* scene, Camera* camera, ePipelineMode pipmode)
+{
+	std::vector<renderCall>* calls = &renderCallList;
+	if (use_render_cache && camera)
+		calls = &getCachedRenderCalls(scene, camera);
+	else
+		collectRenderCalls(scene, camera);
+
+	//shadow maps keep the casters hidden from the camera
+	if (use_occlusion && camera && !rendering_shadowmap)
+		calls = &applyOcclusionCulling(*calls, camera);
+
+	//the cached shadowmaps draw the static and the dynamic casters apart
+	if (rendering_shadowmap && caster_layer != ALL_CASTERS)
+		calls = &filterCasterLayer(*calls);
+
+	if (pipmode == FORWARD)
+		renderForward(scene, *calls, camera);
+	else if (pipmode == DEFERRED)
+		renderDeferred(scene, *calls, camera);
+}
+
+std::vector<renderCall>& Renderer::applyOcclusionCulling(std::vector<renderCall>& calls, Camera* camera)
+{
+	occlusion.clear(camera->viewprojection_matrix);
+
+	//the opaque objects that look bigger from the camera are the best occluders
+	occluder_candidates.clear();
+	for (int i = 0; i < calls.size(); ++i)
+	{
+		renderCall& rc = calls[i];
+		if (rc.material->alpha_mode != NO_ALPHA || !rc.mesh->getNumVertices())
+			continue;
+		int num_triangles = (rc.mesh->m_indices.size() ? rc.mesh->m_indices.size() : rc.mesh->getNumVertices()) / 3;
+		if (num_triangles > max_occluder_triangles)
+			continue;
+		occluder_candidates.push_back(i);
+	}
+
+	int num_occluders = std::min((int)occluder_candidates.size(), max_occluders);
+	std::partial_sort(occluder_candidates.begin(), occluder_candidates.begin() + num_occluders, occluder_candidates.end(),
+		[&calls, camera](int a, int b) {
+			const BoundingBox& box_a = calls[a].world_bounding;
+			const BoundingBox& box_b = calls[b].world_bounding;
+			return box_a.halfsize.length() / std::max(camera->eye.distance(box_a.center), 0.01f) >
+				box_b.halfsize.length() / std::max(camera->eye.distance(box_b.center), 0.01f);
+		});
+
+	for (int i = 0; i < num_occluders; ++i)
+	{
+		renderCall& rc = calls[occluder_candidates[i]];
+		Mesh* mesh = rc.mesh;
+		const unsigned int* indices = mesh->m_indices.size() ? &mesh->m_indices[0] : NULL;
+		if (mesh->interleaved.size())
+			occlusion.addOccluder(rc.model, &mesh->interleaved[0].vertex, sizeof(Mesh::tInterleaved), mesh->interleaved.size(), indices, mesh->m_indices.size());
+		else
+			occlusion.addOccluder(rc.model, &mesh->vertices[0], sizeof(Vector3), mesh->vertices.size(), indices, mesh->m_indices.size());
+	}
+	occlusion.rasterize();
+
+	//test the boxes in parallel, the order of the list is kept
+	const int calls_per_task = 256;
+	occlusion_mask.resize(calls.size());
+	JobSystem::get()->parallelFor((calls.size() + calls_per_task - 1) / calls_per_task, [this, &calls, calls_per_task](int task) {
+		int end = std::min((int)calls.size(), (task + 1) * calls_per_task);
+		for (int i = task * calls_per_task; i < end; ++i)
+			occlusion_mask[i] = occlusion.isOccluded(calls[i].world_bounding);
+	});
+
+	occlusion_calls.clear();
+	for (int i = 0; i < calls.size(); ++i)
+		if (!occlusion_mask[i])
+			occlusion_calls.push_back(calls[i]);
+
+	occlusion_tested = calls.size();
+	occlusion_culled = calls.size() - occlusion_calls.size();
+	return occlusion_calls;
+}
+
+void Renderer::benchmarkOcclusion(GTR::Scene* scene, Camera* camera, int iterations) {
+
+	typedef std::chrono::high_resolution_clock clock;
+
+	std::vector<renderCall> calls = getCachedRenderCalls(scene, camera);
+
+	clock::time_point start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+		applyOcclusionCulling(calls, camera);
+	double time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+
+	//only the rasterization, with one thread and with all of them
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+		occlusion.rasterize(false);
+	double single_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+
+	start = clock::now();
+	for (int i = 0; i < iterations; ++i)
+		occlusion.rasterize(true);
+	double threaded_time = std::chrono::duration<double, std::milli>(clock::now() - start).count() / iterations;
+
+	std::cout << "Occlusion benchmark (" << calls.size() << " calls, " << occlusion.num_occluders << " occluders, " << occlusion.num_triangles << " triangles)" << std::endl;
+	std::cout << "\t total: " << time << " ms, " << occlusion_culled << " culled" << std::endl;
+	std::cout << "\t rasterize 1 thread: " << single_time << " ms" << std::endl;
+	std::cout << "\t rasterize " << JobSystem::get()->getNumThreads() << " threads: " << threaded_time << " ms" << std::endl;
+}
+
+//renders all the prefab
+void Renderer::getRenderCallsFromPrefabs(BaseEntity* entity, GTR::Prefab* prefab, Camera* camera, sCollectBuffers& buffers, std::vector<renderCall>& output)
+{
+	assert(prefab && "PREFAB IS NULL");
+
+	CompiledPrefab& compiled = prefab->compiled;
+	if (!compiled.nodes.size())
+		prefab->compile();
+
+	buffers.boxes.clear();
+	buffers.models.clear();
+	buffers.nodes.clear();
+
+	//the node matrices are already relative to the prefab, only the entity model is missing
+	for (int i = 0; i < compiled.render_nodes.size(); ++i)
+	{
+		int index = compiled.render_nodes[i];
+		if (!compiled.visible[index])
+			continue;
+
+		Matrix44 node_model = compiled.models[index] * entity->model;
+		buffers.models.push_back(node_model);
+		buffers.boxes.add(transformBoundingBox(node_model, compiled.boxes[index]));
+		buffers.nodes.push_back(index);
+	}
+
+	//test all the boxes of the prefab at once
+	buffers.mask.resize(buffers.nodes.size());
+	if (camera && buffers.nodes.size())
+		camera->testBoxesInFrustum(buffers.boxes, &buffers.mask[0]);
+
+	for (int i = 0; i < buffers.nodes.size(); ++i)
+	{
+		if (camera && !buffers.mask[i])
+			continue;
+
+		int index = buffers.nodes[i];
+		renderCall aux;
+		aux.model = buffers.models[i];
+		aux.mesh = compiled.meshes[index];
+		aux.material = compiled.materials[index];
+		aux.world_bounding = BoundingBox(Vector3(buffers.boxes.cx[i], buffers.boxes.cy[i], buffers.boxes.cz[i]), Vector3(buffers.boxes.hx[i], buffers.boxes.hy[i], buffers.boxes.hz[i]));
+		aux.entity = entity;
+		if (camera)
+			aux.distance_to_cam = camera->eye.distance(aux.world_bounding.center);
+		aux.lod = selectLOD(aux.mesh, aux.model, aux.world_bounding, camera);
+		output.push_back(aux);
+	}
+}
+
+//renders a node of the prefab and its children
+void Renderer::getRenderCallsFromNode(BaseEntity* entity, GTR::Node* node, Camera* camera)
+{
+	if (!node->visible)
+		return;
+
+	//compute global matrix
+	Matrix44 node_model = node->getGlobalMatrix(true) * entity->model;
+
+	//does this node have a mesh? then we must render it
+	if (node->mesh && node->material)
+	{
+		//compute the bounding box of the object in world space (by using the mesh bounding box transformed to world space)
+		BoundingBox world_bounding = transformBoundingBox(node_model,node->mesh->box);
+
+		//if bounding box is inside the camera frustum then the object is probably visible
+		if (!camera || camera->testBoxInFrustum(world_bounding.center, world_bounding.halfsize))
+		{
+
+			renderCall aux;
+
+			aux.model = node_model;
+			aux.mesh = node->mesh;
+			aux.material = node->material;
+			aux.world_bounding = world_bounding;
+			aux.entity = entity;
+			if(camera)
+				aux.distance_to_cam = camera->eye.distance(world_bounding.center);
+			//uso el centro de la bounding box para la distancia
+			aux.lod = selectLOD(node->mesh, node_model, world_bounding, camera);
+
+			this->renderCallList.push_back(aux);
+
+		}
+	}
+
+	//iterate recursively with children
+	for (int i = 0; i < node->children.size(); ++i)
+		getRenderCallsFromNode(entity, node->children[i], camera);
+}
+
+int Renderer::selectLOD(Mesh* mesh, const Matrix44& model, const BoundingBox& world_bounding, Camera* camera)
+{
+	if (!use_lods || !camera || !mesh->lods.size())
+		return 0;
+
+	//too close, the camera could be inside the object
+	if (camera->eye.distance(world_bounding.center) <= world_bounding.halfsize.length())
+		return 0;
+
+	//the errors are in mesh units, use the largest scale of the model
+	float scale = Vector3(model.m[0], model.m[1], model.m[2]).length();
+	scale = std::max(scale, (float)Vector3(model.m[4], model.m[5], model.m[6]).length());
+	scale = std::max(scale, (float)Vector3(model.m[8], model.m[9], model.m[10]).length());
+
+	//a level is only used when the change is not visible, so there is no popping
+	for (int lod = mesh->getNumLODs() - 1; lod > 0; --lod)
+		if (camera->getProjectedScale(world_bounding.center, mesh->getLODError(lod) * scale) < lod_max_error)
+			return lod;
+	return 0;
+}
+
+void Renderer::buildInstanceGroups(std::vector<renderCall>& calls, bool skip_blended)
+{
+	instance_groups.clear();
+	instance_models.clear();
+
+	int i = 0;
+	while (i < calls.size())
+	{
+		renderCall& rc = calls[i];
+		if (skip_blended && rc.material->alpha_mode == eAlphaMode::BLEND)
+		{
+			++i;
+			continue;
+		}
+
+		//the sort keys place the calls with the same material and mesh together
+		int end = i + 1;
+		if (use_instancing && rc.material->alpha_mode != eAlphaMode::BLEND)
+			while (end < calls.size() && calls[end].mesh == rc.mesh && calls[end].material == rc.material)
+				++end;
+
+		//one group for every lod used inside the run
+		int num_lods = end - i > 1 ? rc.mesh->getNumLODs() : 1;
+		for (int lod = 0; lod < num_lods; ++lod)
+		{
+			sInstanceGroup group;
+			group.mesh = rc.mesh;
+			group.material = rc.material;
+			group.lod = end - i > 1 ? lod : rc.lod;
+			group.first = instance_models.size();
+			for (int j = i; j < end; ++j)
+				if (end - i == 1 || calls[j].lod == lod)
+					instance_models.push_back(calls[j].model);
+			group.count = instance_models.size() - group.first;
+			if (group.count)
+				instance_groups.push_back(group);
+		}
+		i = end;
+	}
+}
+
+void Renderer::renderCallsInstanced(eRenderMode mode, GTR::Scene* scene, std::vector<renderCall>& calls, Camera* camera, bool skip_blended)
+{
+	buildInstanceGroups(calls, skip_blended);
+
+	for (int i = 0; i < instance_groups.size(); ++i)
+	{
+		sInstanceGroup& group = instance_groups[i];
+		const Matrix44& model = instance_models[group.first];
+
+		//the groups of the same bucket (material and arena) differ only in the draw range
+		int end = i + 1;
+		if (use_multidraw && group.mesh->arena && group.material->alpha_mode != eAlphaMode::BLEND)
+			while (end < instance_groups.size() && instance_groups[end].material == group.material && instance_groups[end].mesh->arena == group.mesh->arena)
+				++end;
+		if (end - i > 1)
+		{
+			renderMeshWithMaterial(mode, scene, model, group.mesh, group.material, camera, group.lod, NULL, 0, &group, end - i);
+			multidraw_groups += end - i;
+			multidraws++;
+			i = end - 1;
+			continue;
+		}
+
+		if (group.count == 1)
+		{
+			renderMeshWithMaterial(mode, scene, model, group.mesh, group.material, camera, group.lod);
+			continue;
+		}
+		renderMeshWithMaterial(mode, scene, model, group.mesh, group.material, camera, group.lod, &model, group.count);
+		instanced_calls += group.count;
+		instanced_draws++;
+	}
+
+	//the shader stays enabled between calls so consecutive calls with the same one do not rebind it
+	if (Shader::current)
+		Shader::current->disable();
+}
+
+//renders a mesh given its transform and material
+void Renderer::renderMeshWithMaterial(eRenderMode mode, GTR::Scene* scene, const Matrix44 model, Mesh* mesh, GTR::Material* material, Camera* camera, int lod, const Matrix44* instances, int num_instances, const sInstanceGroup* groups, int num_groups)
+{
+	//in case there is nothing to do
+	if (!mesh || !mesh->getNumVertices() || !material )
+		return;
+    assert(glGetError() == GL_NO_ERROR);
+
+	//define locals to simplify coding
+	Shader* shader = NULL;
+	Texture* texture = NULL;
+	texture = material->color_texture.texture;
+	if (texture == NULL)
+		texture = Texture::getWhiteTexture(); //a 1x1 white texture
+
+	if (rendering_shadowmap && mode == DEFAULT) {
+		renderMeshInShadowMap(material, camera, model, mesh, texture, lod, instances, num_instances, groups, num_groups);
+		return;
+	}
+
+	//every mesh is drawn once with the lights of its clusters
+	if (use_clustered_forward && (mode == DEFAULT || mode == SINGLE))
+		mode = CLUSTERED;
+
+	Texture* metallic_roughness_texture = material->metallic_roughness_texture.texture;
+	if (metallic_roughness_texture == NULL)
+		metallic_roughness_texture = Texture::getWhiteTexture(); //a 1x1 white texture
+
+
+	Texture* emmisive_texture = material->emissive_texture.texture;
+	if (emmisive_texture == NULL)
+		emmisive_texture = Texture::getWhiteTexture(); //a 1x1 white texture
+
+	Texture* normalmap = material->normal_texture.texture;
+	if (!normalmap) {
+		normalmap = Texture::getWhiteTexture(); //a 1x1 white texture
+	}
+
+	//select the blending
+	if (material->alpha_mode == GTR::eAlphaMode::BLEND)
+	{
+		GLState::enable(GL_BLEND);
+		GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else
+		GLState::disable(GL_BLEND);
+
+	//select if render both sides of the triangles
+	if(material->two_sided)
+		GLState::disable(GL_CULL_FACE);
+	else
+		GLState::enable(GL_CULL_FACE);
+
+	//chose a shader
+	//the instanced versions read the model from an attribute
+	bool instanced = num_instances || num_groups;
+	shader = Shader::fromHandle(mesh_shaders[mode][instanced ? 1 : 0]);
+
+	//no shader? then nothing to render
+	if (!shader)
+		return;
+	shader->enable();
+
+	//camera, time, ambient and lights are in the uniform blocks, only the model and the material change per draw
+	shader->setUniform(SID("u_model"), model);
+	useMaterialBlock(shader, material);
+
+	if(texture)
+		shader->setUniform(SID("u_texture"), texture, 0);
+	if (metallic_roughness_texture)
+		shader->setUniform(SID("u_metallic_roughness_texture"), metallic_roughness_texture, 1);
+	if(emmisive_texture)
+		shader->setUniform(SID("u_emmisive_texture"), emmisive_texture, 2);
+	if(normalmap)
+		shader->setUniform(SID("u_normalmap"), normalmap, 3);
+
+	if (mode == DEFAULT) {
+		std::vector<GTR::LightEntity*>& lights = scene->lights;
+		for (size_t i = 0; i < lights.size() && i < 5; i++) {
+			lights[i]->setLightUniforms(shader, true);
+			shader->setUniform(SID("u_first_pass"), i == 0);
+
+			if (i != 0) {
+				GLState::depthFunc(GL_LEQUAL);
+				GLState::blendFunc(GL_SRC_ALPHA, GL_ONE);
+
+				GLState::enable(GL_BLEND);
+			}
+			drawGeometry(mesh, lod, instances, num_instances, groups, num_groups);
+		}
+		GLState::depthFunc(GL_LESS);
+	}
+
+	else if (mode == CLUSTERED) {
+		//the lights with shadows read their tile of the atlas
+		if (shadow_atlas.fbo.depth_texture)
+			shader->setTexture(SID("u_shadowmap"), shadow_atlas.fbo.depth_texture, 20);
+		//the pages after the first one only add their lights, like the passes of DEFAULT
+		shader->setUniform(SID("u_first_pass"), light_page == 0);
+		if (light_page > 0) {
+			GLState::depthFunc(GL_LEQUAL);
+			GLState::blendFunc(GL_SRC_ALPHA, GL_ONE);
+			GLState::enable(GL_BLEND);
+		}
+		drawGeometry(mesh, lod, instances, num_instances, groups, num_groups);
+		GLState::depthFunc(GL_LESS);
+	}
+
+	else {
+		//do the draw call that renders the mesh into the screen
+		drawGeometry(mesh, lod, instances, num_instances, groups, num_groups);
+	}
+
+	//the shader is not disabled, the next call probably uses the same one
+
+	//set the render state as it was before to avoid problems with future renders
+	GLState::disable(GL_BLEND);
+}
+
+void Renderer::renderMeshInShadowMap(Material* material, Camera* camera, Matrix44 model, Mesh* mesh, Texture* texture, int lod, const Matrix44* instances, int num_instances, const sInstanceGroup* groups, int num_groups)
+{
+	Shader* shader = Shader::fromHandle(mesh_shaders[SHOW_TEXTURE][num_instances || num_groups ? 1 : 0]);
+
+	if (material->alpha_mode == GTR::BLEND) return;
+
+	shader->enable();
+
+	//the light camera is in the frame block
+	shader->setUniform(SID("u_model"), model);
+	useMaterialBlock(shader, material);
+	shader->setUniform(SID("u_texture"), texture, 0);
+
+	drawGeometry(mesh, lod, instances, num_instances, groups, num_groups);
+}
+
+void Renderer::drawGeometry(Mesh* mesh, int lod, const Matrix44* instances, int num_instances, const sInstanceGroup* groups, int num_groups)
+{
+	if (num_groups)
+	{
+		//the models of consecutive groups are consecutive in instance_models
+		int first = groups[0].first;
+		multi_draw_items.resize(num_groups);
+		for (int i = 0; i < num_groups; ++i)
+		{
+			sMultiDrawItem& item = multi_draw_items[i];
+			item.mesh = groups[i].mesh;
+			item.lod = groups[i].lod;
+			item.first_instance = groups[i].first - first;
+			item.num_instances = groups[i].count;
+		}
+		const sInstanceGroup& last = groups[num_groups - 1];
+		mesh->arena->drawMultiple(GL_TRIANGLES, &multi_draw_items[0], num_groups, &instance_models[first], last.first + last.count - first);
+	}
+	else if (num_instances)
+		mesh->renderInstanced(GL_TRIANGLES, instances, num_instances, lod);
+	else
+		mesh->render(GL_TRIANGLES, -1, 0, lod);
+}
+
+void Renderer::updateFrameBlock(GTR::Scene* scene, Camera* camera)
+{
+	frame_block.viewprojection = camera->viewprojection_matrix;
+	frame_block.camera_position = camera->eye;
+	frame_block.time = getTime();
+	frame_block.ambient_light = blend_mode != FORWARD_BLEND ? scene->ambient_light : Vector3(0.0, 0.0, 0.0);
+	frame_block.dithering = blend_mode == DITHERING;
+
+	if (!frame_ubo.ubo_id)
+	{
+		frame_ubo.create(sizeof(sFrameBlock), &frame_block);
+		frame_ubo.bind(FRAME_BLOCK_BINDING);
+	}
+	else
+		frame_ubo.update(&frame_block, sizeof(sFrameBlock));
+}
+
+void Renderer::updateLightBlock(GTR::Scene* scene)
+{
+	//the lights fill the pages in order, there is always one even without lights
+	int num_pages = std::max(((int)scene->lights.size() + MAX_BLOCK_LIGHTS - 1) / MAX_BLOCK_LIGHTS, 1);
+	light_pages.resize(num_pages);
+	for (int p = 0; p < num_pages; ++p)
+	{
+		sLightBlock& block = light_pages[p];
+		block.num_lights = 0;
+		block.cascade_light = -1;
+		block.num_cascades = num_active_cascades;
+		for (int i = 0; i < num_active_cascades; ++i)
+		{
+			block.cascade_viewproj[i] = cascade_cameras[i].viewprojection_matrix;
+			block.cascade_rect[i] = shadow_atlas.getRect(cascade_tiles[i]);
+		}
+	}
+
+	for (int n = 0; n < scene->lights.size(); ++n)
+	{
+		LightEntity* light = scene->lights[n];
+		sLightBlock& block = light_pages[n / MAX_BLOCK_LIGHTS];
+		int i = block.num_lights++;
+
+		bool cast = light->cast_shadows && light->fbo;
+		light->block_index = i;
+		light->block_page = n / MAX_BLOCK_LIGHTS;
+		block.position[i] = Vector4(light->model.getTranslation(), (float)light->light_type);
+		block.color[i] = Vector4(light->color, light->intensity);
+		block.direction[i] = Vector4(light->model.frontVector(), light->max_distance);
+		block.params[i] = Vector4(cos((light->cone_angle / 180.0) * PI), light->spot_exponent, clamp(light->shadow_bias, 0.015, 1.0), cast ? 1.0 : 0.0);
+		block.shadow_rect[i] = cast ? shadow_atlas.getRect(light->shadow_tile) : Vector4(0, 0, 1, 1);
+		block.shadow_viewproj[i] = light->camera.viewprojection_matrix;
+		if (light == cascade_light && light->fbo)
+			block.cascade_light = i;
+	}
+
+	//the buffer only grows, the pages are uploaded one by one because of the alignment
+	if (light_ubo.size < num_pages * LIGHT_PAGE_SIZE)
+		light_ubo.create(num_pages * LIGHT_PAGE_SIZE);
+	for (int p = 0; p < num_pages; ++p)
+		light_ubo.update(&light_pages[p], sizeof(sLightBlock), p * LIGHT_PAGE_SIZE);
+	light_page = -1;
+	useLightPage(0);
+}
+
+void Renderer::useLightPage(int page)
+{
+	if (page == light_page)
+		return;
+	light_ubo.bindRange(LIGHT_BLOCK_BINDING, page * LIGHT_PAGE_SIZE, sizeof(sLightBlock));
+	light_page = page;
+}
+
+void Renderer::updateClusterBlock(GTR::Scene* scene, Camera* camera)
+{
+	light_clusters.update(camera, scene->lights, light_page);
+
+	if (!cluster_ubo.ubo_id)
+	{
+		cluster_ubo.create(sizeof(sClusterBlock), &light_clusters.block);
+		cluster_ubo.bind(CLUSTER_BLOCK_BINDING);
+	}
+	else
+		cluster_ubo.update(&light_clusters.block, sizeof(sClusterBlock));
+}
+
+static void fillMaterialData(GTR::Material* material, sMaterialData& data)
+{
+	data.color = material->color;
+	data.emissive_factor = material->emissive_factor;
+	data.alpha_cutoff = material->alpha_mode == GTR::eAlphaMode::MASK ? material->alpha_cutoff : 0;
+	data.metallic_factor = material->metallic_factor;
+	data.roughness_factor = material->roughness_factor;
+	material->block_dirty = false;
+}
+
+static void addNodeMaterials(GTR::Node* node, std::vector<GTR::Material*>& materials)
+{
+	if (node->material)
+		materials.push_back(node->material);
+	for (int i = 0; i < node->children.size(); ++i)
+		addNodeMaterials(node->children[i], materials);
+}
+
+void Renderer::uploadMaterialBlocks(GTR::Scene* scene)
+{
+	const int page_size = MATERIALS_PER_BLOCK * sizeof(sMaterialData);
+
+	std::vector<GTR::Material*> materials;
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (ent->entity_type == PREFAB && ((PrefabEntity*)ent)->prefab)
+			addNodeMaterials(&((PrefabEntity*)ent)->prefab->root, materials);
+	}
+
+	//materials shared by several nodes or prefabs keep the slot they got first
+	for (int i = 0; i < materials.size(); ++i)
+	{
+		GTR::Material* material = materials[i];
+		if (material->block_index == -1)
+		{
+			material->block_index = materials_data.size();
+			materials_data.push_back(sMaterialData());
+			material->block_dirty = true;
+		}
+		if (material->block_dirty)
+			fillMaterialData(material, materials_data[material->block_index]);
+	}
+	if (!materials_data.size())
+		return;
+
+	int needed = ((materials_data.size() + MATERIALS_PER_BLOCK - 1) / MATERIALS_PER_BLOCK) * page_size;
+	if (material_ubo.size < needed)
+		material_ubo.create(needed);
+	material_ubo.update(&materials_data[0], materials_data.size() * sizeof(sMaterialData));
+	material_page = -1;
+}
+
+void Renderer::useMaterialBlock(Shader* shader, GTR::Material* material)
+{
+	const int page_size = MATERIALS_PER_BLOCK * sizeof(sMaterialData);
+
+	//materials created after the scene was loaded get their slot here
+	if (material->block_index == -1)
+	{
+		material->block_index = materials_data.size();
+		materials_data.push_back(sMaterialData());
+		material->block_dirty = true;
+	}
+
+	//the ones loaded with the scene were already uploaded, this only happens after being edited
+	if (material->block_dirty)
+	{
+		sMaterialData& data = materials_data[material->block_index];
+		fillMaterialData(material, data);
+
+		//the buffer grows one page at a time
+		int needed = ((materials_data.size() + MATERIALS_PER_BLOCK - 1) / MATERIALS_PER_BLOCK) * page_size;
+		if (material_ubo.size < needed)
+		{
+			material_ubo.create(needed);
+			material_ubo.update(&materials_data[0], materials_data.size() * sizeof(sMaterialData));
+			material_page = -1;
+		}
+		else
+			material_ubo.update(&data, sizeof(sMaterialData), material->block_index * sizeof(sMaterialData));
+	}
+
+	int page = material->block_index / MATERIALS_PER_BLOCK;
+	if (page != material_page)
+	{
+		material_ubo.bindRange(MATERIAL_BLOCK_BINDING, page * page_size, page_size);
+		material_page = page;
+	}
+	shader->setUniform(SID("u_material_index"), material->block_index % MATERIALS_PER_BLOCK);
+}
+
+float Renderer::getShadowImportance(LightEntity* light, Camera* camera)
+{
+	//the directional light reaches the whole view
+	if (light->light_type == DIRECTIONAL)
+		return 1.0;
+
+	Vector3 center;
+	float radius;
+	light->getBoundingSphere(center, radius);
+	if (camera->testSphereInFrustum(center, radius) == CLIP_OUTSIDE)
+		return 0.0;
+
+	//half of the screen height covered by the sphere, narrow cones have smaller spheres
+	float distance = std::max(camera->eye.distance(center) - radius, camera->near_plane);
+	float importance = radius / (distance * tan(camera->fov * 0.5 * DEG2RAD));
+	return clamp(importance, 0.001, 1.0);
+}
+
+void Renderer::assignShadowTiles(GTR::Scene* scene, Camera* camera)
+{
+	shadow_requests.clear();
+	cascade_light = NULL;
+	for (int i = 0; i < scene->lights.size(); ++i)
+	{
+		LightEntity* light = scene->lights[i];
+
+		//the cascades take the place of the tile of the first directional light
+		if (use_cascades && !cascade_light && light->cast_shadows && light->light_type == DIRECTIONAL)
+		{
+			shadow_atlas.release(light->shadow_tile);
+			cascade_light = light;
+			continue;
+		}
+
+		//only spots and directionals have a shadow camera
+		float importance = 0.0;
+		if (light->cast_shadows && light->light_type != POINT)
+			importance = getShadowImportance(light, camera);
+		if (importance <= 0.0)
+		{
+			shadow_atlas.release(light->shadow_tile);
+			light->fbo = NULL;
+			continue;
+		}
+
+		sShadowRequest request;
+		request.light = light;
+		request.importance = importance;
+		request.size = ShadowAtlas::MIN_TILE_SIZE;
+		while (request.size < MAX_SHADOW_TILE_SIZE && request.size < importance * MAX_SHADOW_TILE_SIZE)
+			request.size *= 2;
+		shadow_requests.push_back(request);
+	}
+
+	std::sort(shadow_requests.begin(), shadow_requests.end(), [](const sShadowRequest& a, const sShadowRequest& b) { return a.importance > b.importance; });
+
+	//too many pixels, the less important lights get smaller tiles and then none
+	long long total = 0;
+	long long budget = (long long)SHADOW_ATLAS_SIZE * SHADOW_ATLAS_SIZE;
+	if (cascade_light)
+		budget -= (long long)num_cascades * CASCADE_TILE_SIZE * CASCADE_TILE_SIZE;
+	for (int i = 0; i < shadow_requests.size(); ++i)
+		total += (long long)shadow_requests[i].size * shadow_requests[i].size;
+	for (int i = (int)shadow_requests.size() - 1; i >= 0 && total > budget; --i)
+	{
+		sShadowRequest& request = shadow_requests[i];
+		while (request.size > ShadowAtlas::MIN_TILE_SIZE && total > budget)
+		{
+			total -= (long long)request.size * request.size * 3 / 4;
+			request.size /= 2;
+		}
+	}
+	for (int i = (int)shadow_requests.size() - 1; i >= 0 && total > budget; --i)
+	{
+		total -= (long long)shadow_requests[i].size * shadow_requests[i].size;
+		shadow_requests[i].size = 0;
+	}
+
+	//free first the tiles that are too big, so the others find room
+	for (int i = 0; i < shadow_requests.size(); ++i)
+	{
+		LightEntity* light = shadow_requests[i].light;
+		if (light->shadow_tile.size > shadow_requests[i].size)
+			shadow_atlas.release(light->shadow_tile);
+	}
+
+	assignCascadeTiles();
+
+	//a light that can not get a tile of its size tries smaller ones or keeps the tile it had
+	for (int i = 0; i < shadow_requests.size(); ++i)
+	{
+		LightEntity* light = shadow_requests[i].light;
+		for (int size = shadow_requests[i].size; size >= ShadowAtlas::MIN_TILE_SIZE && light->shadow_tile.size < size; size /= 2)
+		{
+			sShadowTile tile;
+			if (!shadow_atlas.allocate(size, tile))
+				continue;
+			shadow_atlas.release(light->shadow_tile);
+			light->shadow_tile = tile;
+		}
+		light->fbo = light->shadow_tile.size ? &shadow_atlas.fbo : NULL;
+	}
+}
+
+void Renderer::assignCascadeTiles()
+{
+	int wanted = cascade_light ? num_cascades : 0;
+	for (int i = wanted; i < MAX_CASCADES; ++i)
+		shadow_atlas.release(cascade_tiles[i]);
+
+	num_active_cascades = 0;
+	for (int i = 0; i < wanted; ++i)
+	{
+		if (!cascade_tiles[i].size && !shadow_atlas.allocate(CASCADE_TILE_SIZE, cascade_tiles[i]))
+		{
+			//the budget leaves room for the cascades, the tiles of the lights are split in pieces, they get new ones next
+			for (int j = 0; j < shadow_requests.size(); ++j)
+				shadow_atlas.release(shadow_requests[j].light->shadow_tile);
+			if (!shadow_atlas.allocate(CASCADE_TILE_SIZE, cascade_tiles[i]))
+				break;
+		}
+		num_active_cascades++;
+	}
+
+	if (cascade_light)
+		cascade_light->fbo = num_active_cascades ? &shadow_atlas.fbo : NULL;
+}
+
+void Renderer::fitCascades(Camera* camera)
+{
+	//practical split scheme, the closest cascades cover less depth
+	float near_plane = camera->near_plane;
+	float far_plane = std::min(camera->far_plane, cascades_distance);
+	for (int i = 0; i <= num_active_cascades; ++i)
+	{
+		float f = i / (float)num_active_cascades;
+		float log_split = near_plane * pow(far_plane / near_plane, f);
+		float uniform_split = near_plane + (far_plane - near_plane) * f;
+		cascade_splits[i] = cascades_lambda * log_split + (1.0 - cascades_lambda) * uniform_split;
+	}
+
+	Vector3 front = camera->center - camera->eye;
+	front.normalize();
+	Vector3 right = front.cross(camera->up);
+	right.normalize();
+	Vector3 up = right.cross(front);
+	float tan_y = tan(camera->fov * 0.5 * DEG2RAD);
+	float tan_x = tan_y * camera->aspect;
+
+	//light space with the same axes as the cascade cameras, to snap the centers
+	Vector3 dir = cascade_light->model.frontVector();
+	dir.normalize();
+	Camera light_view;
+	light_view.lookAt(Vector3(0, 0, 0), dir, Vector3(0, 1.001, 0));
+	Matrix44 to_light = light_view.view_matrix;
+	Matrix44 from_light = to_light;
+	from_light.inverse();
+
+	for (int i = 0; i < num_active_cascades; ++i)
+	{
+		//bounding sphere of the slice, its size does not change when the camera rotates
+		Vector3 corners[8];
+		Vector3 center(0, 0, 0);
+		for (int j = 0; j < 8; ++j)
+		{
+			float depth = cascade_splits[i + (j >> 2)];
+			corners[j] = camera->eye + front * depth + right * (depth * tan_x * (j & 1 ? 1.0 : -1.0)) + up * (depth * tan_y * (j & 2 ? 1.0 : -1.0));
+			center = center + corners[j];
+		}
+		center = center * (1.0 / 8.0);
+		float radius = 0.0;
+		for (int j = 0; j < 8; ++j)
+			radius = std::max(radius, (float)corners[j].distance(center));
+		radius = ceil(radius);
+
+		//the center moves in whole texels, so the shadow edges do not swim when the camera moves
+		float texel = 2.0 * radius / CASCADE_TILE_SIZE;
+		Vector3 light_center = to_light * center;
+		light_center.x = floor(light_center.x / texel) * texel;
+		light_center.y = floor(light_center.y / texel) * texel;
+		center = from_light * light_center;
+
+		//the camera is pulled back to catch the casters between the light and the slice
+		const float caster_distance = 1000.0;
+		Camera& cascade = cascade_cameras[i];
+		cascade.lookAt(center - dir * (radius + caster_distance), center, Vector3(0, 1.001, 0));
+		cascade.setOrthographic(-radius, radius, -radius, radius, 0.0, 2.0 * radius + caster_distance);
+	}
+}
+
+void Renderer::renderSceneShadowmaps(GTR::Scene* scene, Camera* camera)
+{
+	if (!shadow_atlas.size)
+	{
+		shadow_atlas.create(SHADOW_ATLAS_SIZE);
+		static_shadow_fbo.setDepthOnly(SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE);
+	}
+
+	assignShadowTiles(scene, camera);
+	updateCasterStates(scene);
+	if (num_active_cascades)
+		fitCascades(camera);
+
+	rendering_shadowmap = true;
+	num_shadow_tiles = 0;
+	num_shadow_reused = 0;
+	num_shadow_rerendered = 0;
+	num_shadow_dynamic = 0;
+	num_shadow_lost_texels = 0;
+
+	shadow_atlas.fbo.bind();
+	glColorMask(false, false, false, false);
+
+	//the clears of the passes only touch the tile
+	glEnable(GL_SCISSOR_TEST);
+	for (size_t i = 0; i < scene->lights.size(); i++) {
+		GTR::LightEntity* light = scene->lights[i];
+		if (!light->fbo || light == cascade_light)
+			continue;
+
+		renderShadowTile(scene, &light->camera, light->shadow_tile);
+		num_shadow_tiles++;
+	}
+	for (int i = 0; i < num_active_cascades; ++i)
+	{
+		renderShadowTile(scene, &cascade_cameras[i], cascade_tiles[i]);
+		num_shadow_tiles++;
+	}
+	glDisable(GL_SCISSOR_TEST);
+
+	shadow_atlas.fbo.unbind();
+	glColorMask(true, true, true, true);
+	rendering_shadowmap = false;
+}
+
+void Renderer::renderShadowTile(GTR::Scene* scene, Camera* camera, const sShadowTile& tile)
+{
+	glViewport(tile.x, tile.y, tile.size, tile.size);
+	glScissor(tile.x, tile.y, tile.size, tile.size);
+
+	if (!use_shadow_cache)
+	{
+		glClear(GL_DEPTH_BUFFER_BIT);
+		renderScene(scene, camera, GTR::ePipelineMode::FORWARD);
+		num_shadow_rerendered++;
+		return;
+	}
+
+	//the static layer is valid if the light did not change, kept its tile and no static caster changed inside
+	sShadowCache& cache = shadow_caches[camera];
+	bool valid = cache.tile.size && cache.frame == shadow_frame - 1 &&
+		cache.tile.x == tile.x && cache.tile.y == tile.y && cache.tile.size == tile.size &&
+		memcmp(cache.viewprojection.m, camera->viewprojection_matrix.m, sizeof(Matrix44)) == 0;
+	for (int i = 0; i < static_changes.size() && valid; ++i)
+		if (camera->testBoxInFrustum(static_changes[i].center, static_changes[i].halfsize) != CLIP_OUTSIDE)
+			valid = false;
+
+	bool has_dynamic = false;
+	for (int i = 0; i < dynamic_bounds.size() && !has_dynamic; ++i)
+		has_dynamic = camera->testBoxInFrustum(dynamic_bounds[i].center, dynamic_bounds[i].halfsize) != CLIP_OUTSIDE;
+
+	if (!valid)
+	{
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, static_shadow_fbo.fbo_id);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		caster_layer = STATIC_CASTERS;
+		renderScene(scene, camera, GTR::ePipelineMode::FORWARD);
+		cache.viewprojection = camera->viewprojection_matrix;
+		cache.tile = tile;
+		num_shadow_rerendered++;
+	}
+	else
+		num_shadow_reused++;
+
+	//the tile of the atlas is the static layer as it was if no dynamic casters were drawn over it
+	if (!valid || has_dynamic || cache.has_dynamic)
+		static_shadow_fbo.copyDepthTo(&shadow_atlas.fbo, tile.x, tile.y, tile.size, tile.size);
+	if (has_dynamic)
+	{
+		if (check_shadow_cache)
+			readShadowTileDepth(tile, shadow_check_depth);
+		caster_layer = DYNAMIC_CASTERS;
+		renderScene(scene, camera, GTR::ePipelineMode::FORWARD);
+		num_shadow_dynamic++;
+		//the dynamic casters can only bring the depth closer, a texel further away means the static layer was lost
+		if (check_shadow_cache)
+		{
+			std::vector<float> depth;
+			readShadowTileDepth(tile, depth);
+			for (size_t i = 0; i < depth.size(); ++i)
+				if (depth[i] > shadow_check_depth[i])
+					num_shadow_lost_texels++;
+		}
+	}
+
+	caster_layer = ALL_CASTERS;
+	cache.has_dynamic = has_dynamic;
+	cache.frame = shadow_frame;
+}
+
+void Renderer::readShadowTileDepth(const sShadowTile& tile, std::vector<float>& depth)
+{
+	depth.resize(tile.size * tile.size);
+	glReadPixels(tile.x, tile.y, tile.size, tile.size, GL_DEPTH_COMPONENT, GL_FLOAT, &depth[0]);
+	checkGLErrors();
+}
+
+bool Renderer::getEntityBounds(BaseEntity* entity, BoundingBox& bounds)
+{
+	if (!entity->visible || entity->entity_type != PREFAB || !((PrefabEntity*)entity)->prefab)
+		return false;
+
+	CompiledPrefab& compiled = ((PrefabEntity*)entity)->prefab->compiled;
+	if (!compiled.nodes.size())
+		((PrefabEntity*)entity)->prefab->compile();
+
+	bool found = false;
+	for (int i = 0; i < compiled.render_nodes.size(); ++i)
+	{
+		int index = compiled.render_nodes[i];
+		if (!compiled.visible[index])
+			continue;
+		BoundingBox box = transformBoundingBox(compiled.models[index] * entity->model, compiled.boxes[index]);
+		bounds = found ? mergeBoundingBoxes(bounds, box) : box;
+		found = true;
+	}
+	return found;
+}
+
+void Renderer::updateCasterStates(GTR::Scene* scene)
+{
+	shadow_frame++;
+	static_changes.clear();
+	dynamic_bounds.clear();
+
+	for (int i = 0; i < scene->entities.size(); ++i)
+	{
+		BaseEntity* ent = scene->entities[i];
+		if (ent->entity_type != PREFAB)
+			continue;
+
+		auto it = caster_states.find(ent);
+		if (it == caster_states.end())
+		{
+			//new entities start in the static layer
+			sCasterState& state = caster_states[ent];
+			state.version = ent->version;
+			state.changed_frame = shadow_frame - DYNAMIC_CASTER_FRAMES;
+			state.seen_frame = shadow_frame;
+			state.dynamic = false;
+			state.has_bounds = getEntityBounds(ent, state.bounds);
+			if (state.has_bounds)
+				static_changes.push_back(state.bounds);
+			continue;
+		}
+
+		sCasterState& state = it->second;
+		state.seen_frame = shadow_frame;
+		if (state.version != ent->version)
+		{
+			//it leaves the static layer, its old place there must be cleared
+			if (!state.dynamic && state.has_bounds)
+				static_changes.push_back(state.bounds);
+			state.version = ent->version;
+			state.changed_frame = shadow_frame;
+			state.dynamic = true;
+			state.has_bounds = getEntityBounds(ent, state.bounds);
+		}
+		else if (state.dynamic && shadow_frame - state.changed_frame >= DYNAMIC_CASTER_FRAMES)
+		{
+			//still long enough, back to the static layer
+			state.dynamic = false;
+			if (state.has_bounds)
+				static_changes.push_back(state.bounds);
+		}
+
+		if (state.dynamic && state.has_bounds)
+			dynamic_bounds.push_back(state.bounds);
+	}
+
+	//entities removed from the scene
+	for (auto it = caster_states.begin(); it != caster_states.end();)
+	{
+		if (it->second.seen_frame == shadow_frame)
+		{
+			++it;
+			continue;
+		}
+		if (!it->second.dynamic && it->second.has_bounds)
+			static_changes.push_back(it->second.bounds);
+		it = caster_states.erase(it);
+	}
+}
+
+std::vector<renderCall>& Renderer::filterCasterLayer(std::vector<renderCall>& calls)
+{
+	bool dynamic = caster_layer == DYNAMIC_CASTERS;
+	layer_calls.clear();
+	for (int i = 0; i < calls.size(); ++i)
+	{
+		auto it = caster_states.find(calls[i].entity);
+		bool is_dynamic = it != caster_states.end() && it->second.dynamic;
+		if (is_dynamic == dynamic)
+			layer_calls.push_back(calls[i]);
+	}
+	return layer_calls;
+}
+
+void Renderer::renderDecalls(GTR::Scene* scene, Camera* camera) { 
+
+	//without decals in the frustum the gbuffers are not touched
+	decals.update(scene);
+	decals.cull(camera, scene);
+	num_decals_drawn = decals.instances.size();
+	if (decals.instances.empty())
+		return;
+
+	Shader* shader = Shader::Get("decalls");
+
+	decals_fbo.bind();
+
+	shader->enable();
+
+	Matrix44 inv_vp = camera->viewprojection_matrix;
+	inv_vp.inverse();
+	shader->setUniform(SID("u_inverse_viewprojection"), inv_vp);
+	shader->setUniform(SID("u_viewprojection"), camera->viewprojection_matrix);
+
+	shader->setUniform(SID("u_camera_pos"), camera->eye);
+	shader->setUniform(SID("u_iRes"), Vector2(1.0 / (float)gbuffers_fbo.depth_texture->width, 1.0 / (float)gbuffers_fbo.depth_texture->height));
+
+	shader->setTexture(SID("u_depth_texture"), gbuffers_fbo.depth_texture, 3);
+	shader->setTexture(SID("u_decal_texture"), decals.albedos, 4);
+
+	//blended over the albedo, the alpha of the target keeps the roughness
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::enable(GL_BLEND);
+	GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glColorMask(true, true, true, false);
+	//only the back faces, so every pixel is blended once and it still works with the camera inside the cube
+	//(the cull state left by the gbuffers depends on the last material drawn)
+	GLState::enable(GL_CULL_FACE);
+	GLState::cullFace(GL_FRONT);
+
+	decals.render();
+
+	GLState::cullFace(GL_BACK);
+	GLState::disable(GL_CULL_FACE);
+	glColorMask(true, true, true, true);
+	GLState::disable(GL_BLEND);
+	shader->disable();
+
+	decals_fbo.unbind();
+}
+
+GTR::SSAOFX::SSAOFX() {
+	points = generateSpherePoints(64, 10.0, true);
+	intensity = 1.0f;
+}
+
+void GTR::SSAOFX::blurTexture(Texture* input, Texture* output)
+{
+	FBO* fbo = Texture::getGlobalFBO(output);
+	fbo->bind();
+
+	Mesh* quad = Mesh::getQuad();
+	Shader* sh = Shader::Get("blur");
+
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::disable(GL_BLEND);
+
+	sh->enable();
+	sh->setTexture(SID("ssaoInput"), input, 9);
+	quad->render(GL_TRIANGLES);
+	sh->disable();
+
+	fbo->unbind();
+}
+
+void GTR::SSAOFX::apply(Texture* depth_buffer, Texture* normal_buffer, Camera* cam, Texture* output) {
+
+	FBO* fbo = Texture::getGlobalFBO(output);
+	fbo->bind();
+
+	Matrix44 innvp = cam->viewprojection_matrix;
+	innvp.inverse();
+
+	Mesh* quad = Mesh::getQuad();
+
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::disable(GL_BLEND);
+
+	Shader* sh = Shader::Get("ssao");
+	sh->enable();
+	sh->setUniform(SID("u_inverse_viewprojection"), innvp);
+	sh->setUniform(SID("u_iRes"), Vector2(1.0 / (float)depth_buffer->width, 1.0 / (float)depth_buffer->height));
+	sh->setUniform3Array(SID("u_points"), points[0].v, points.size());
+
+	sh->setUniform(SID("u_viewprojection"), cam->viewprojection_matrix);
+	sh->setTexture(SID("u_normal_texture"), normal_buffer, 1);
+	sh->setTexture(SID("u_depth_texture"), depth_buffer, 3);
+	quad->render(GL_TRIANGLES);
+
+	sh->disable();
+
+	fbo->unbind();
+}
+
+std::vector<Vector3> GTR::generateSpherePoints(int num,
+	float radius, bool hemi)
+{
+	std::vector<Vector3> points;
+	points.resize(num);
+	for (int i = 0; i < num; i += 3)
+	{
+		Vector3& p = points[i];
+		float u = random();
+		float v = random();
+		float theta = u * 2.0 * PI;
+		float phi = acos(2.0 * v - 1.0);
+		float r = cbrt(random() * 0.9 + 0.1) * radius;
+		float sinTheta = sin(theta);
+		float cosTheta = cos(theta);
+		float sinPhi = sin(phi);
+		float cosPhi = cos(phi);
+		p.x = r * sinPhi * cosTheta;
+		p.y = r * sinPhi * sinTheta;
+		p.z = r * cosPhi;
+		if (hemi && p.z < 0)
+			p.z *= -1.0;
+	}
+	return points;
+}
+
+
+void GTR::Renderer::renderInMenu() {
+
+	ImGui::Checkbox("Use BVH culling", &use_bvh);
+	if (use_bvh)
+		ImGui::Text("BVH boxes tested: %d visible: %d accepted by inner nodes: %d", bvh.num_tested, bvh.num_visible, bvh.num_accepted);
+	if (ImGui::Button("Benchmark culling", ImVec2(200.0, 20.0)))
+		benchmarkCulling(Scene::instance, Camera::current, 1000);
+	if (ImGui::Button("Benchmark frustum test", ImVec2(200.0, 20.0)))
+		benchmarkFrustumTest(Scene::instance, Camera::current, 1000);
+	ImGui::Text("Frustum test: %s", getSIMDLevelName(getSIMDLevel()));
+	ImGui::Checkbox("Radix sort render calls", &use_radix_sort);
+	ImGui::Checkbox("Parallel collect", &use_parallel_collect);
+	ImGui::Checkbox("Cache render lists", &use_render_cache);
+	ImGui::Checkbox("Occlusion culling", &use_occlusion);
+	if (use_occlusion)
+	{
+		ImGui::SliderInt("Max occluders", &max_occluders, 1, 64);
+		ImGui::Text("Occluders: %d triangles: %d culled: %d/%d", occlusion.num_occluders, occlusion.num_triangles, occlusion_culled, occlusion_tested);
+	}
+	ImGui::Text("GL state calls: %d skipped: %d", (int)GLState::num_calls, (int)GLState::num_skipped);
+	ImGui::Text("Uniforms uploaded: %d skipped: %d", (int)GLState::num_uniforms, (int)GLState::num_uniforms_skipped);
+	ImGui::Checkbox("Vertex array objects", &Mesh::use_vaos);
+	ImGui::Checkbox("Instancing", &use_instancing);
+	if (use_instancing)
+		ImGui::Text("Instanced: %d calls in %d draws (%d draws saved)", instanced_calls, instanced_draws, instanced_calls - instanced_draws);
+	ImGui::Checkbox("Multi draw", &use_multidraw);
+	if (use_multidraw)
+		ImGui::Text("Multi draw: %d groups in %d draws (%s)", multidraw_groups, multidraws, MeshArena::supportsMultiDrawIndirect() ? "indirect" : "base vertex");
+	ImGui::Text("Draw calls: %d buffer binds: %d arenas: %d", (int)GLState::num_draw_calls, (int)GLState::num_buffer_binds, (int)MeshArena::arenas.size());
+	ImGui::Text("Shadow atlas: %d tiles, %d%% free", num_shadow_tiles, shadow_atlas.size ? (int)(100.0 * shadow_atlas.getFreeArea() / ((double)shadow_atlas.size * shadow_atlas.size)) : 100);
+	ImGui::Checkbox("Shadow cache", &use_shadow_cache);
+	if (use_shadow_cache)
+	{
+		ImGui::Text("Shadowmaps reused: %d re-rendered: %d with dynamic casters: %d", num_shadow_reused, num_shadow_rerendered, num_shadow_dynamic);
+		ImGui::Checkbox("Check static depth", &check_shadow_cache);
+		if (check_shadow_cache)
+			ImGui::Text("Static texels lost under dynamic casters: %d", num_shadow_lost_texels);
+	}
+	ImGui::Text("Decals drawn: %d of %d, %d boxes tested, %d accepted by inner nodes, %d albedo layers", num_decals_drawn, (int)decals.items.size(), decals.num_tested, decals.num_accepted, (int)decals.layers.size());
+	ImGui::Checkbox("Cascaded shadows", &use_cascades);
+	if (use_cascades)
+	{
+		ImGui::SliderInt("Cascades", &num_cascades, 2, MAX_CASCADES);
+		ImGui::SliderFloat("Cascades distance", &cascades_distance, 100.0f, 10000.0f);
+		ImGui::SliderFloat("Cascades split lambda", &cascades_lambda, 0.0f, 1.0f);
+		for (int i = 0; i < num_active_cascades; ++i)
+			ImGui::Text("Cascade %d: %.0f to %.0f", i, cascade_splits[i], cascade_splits[i + 1]);
+	}
+	ImGui::Checkbox("Clustered forward", &use_clustered_forward);
+	if (use_clustered_forward)
+		ImGui::Text("Clusters: %d lights in %d cluster entries (%s), %d light pages", light_clusters.num_lights, light_clusters.num_entries, getSIMDLevelName(getSIMDLevel()), (int)light_pages.size());
+	//the cached lists store the chosen lod, they must be rebuilt
+	bool lods_changed = ImGui::Checkbox("Mesh LODs", &use_lods);
+	if (use_lods)
+		lods_changed |= ImGui::SliderFloat("LOD max error", &lod_max_error, 0.1f, 10.0f);
+	if (lods_changed)
+		for (auto& it : render_caches)
+			it.second.invalidate();
+	if (ImGui::Button("Benchmark occlusion", ImVec2(200.0, 20.0)))
+		benchmarkOcclusion(Scene::instance, Camera::current, 100);
+	if (use_render_cache && render_caches.count(Camera::current))
+	{
+		RenderListCache& cache = render_caches[Camera::current];
+		ImGui::Text("Cached calls: %d evaluated entities: %d %s, %d views cached", (int)cache.calls.size(), cache.num_evaluated, cache.rebuilt ? "(rebuilt)" : "", (int)render_caches.size());
+	}
+	if (ImGui::Button("Benchmark sort", ImVec2(200.0, 20.0)))
+		benchmarkSort(Camera::current, 1000);
+	if (ImGui::Checkbox("Full precision targets", &Texture::use_full_precision))
+		createScreenTargets(Application::instance->window_width, Application::instance->window_height);
+	if (ImGui::Button("Compare target precision", ImVec2(200.0, 20.0)))
+		compare_precision = true;
+	if (precision_max_difference >= 0.0)
+		ImGui::Text("Screen targets: %.1f MB full, %.1f MB policy, max difference %.4f (%.1f/255) mean %.5f",
+			precision_memory[0] / (1024.0 * 1024.0), precision_memory[1] / (1024.0 * 1024.0),
+			precision_max_difference, precision_max_difference * 255.0, precision_mean_difference);
+
+	if (pipeline_mode == GTR::ePipelineMode::DEFERRED) {
+		ImGui::Checkbox("Show gbuffers", &show_gbuffers);
+		ImGui::Checkbox("Show SSAO", &show_ao_buffer);
+		ImGui::Checkbox("Show depth fbo", &show_depthfbo);
+		ImGui::Checkbox("Apply tonemap", &hdr);
+		ImGui::Checkbox("Apply irr", &apply_irr);
+		ImGui::Checkbox("Use only FXAA", &use_only_FXAA);
+		ImGui::Checkbox("Use volumetric", &use_volumetric);
+		ImGui::Checkbox("Use reflection", &use_reflections);
+		ImGui::Checkbox("Use Bloom & DoF", &use_bloom_dof);
+		ImGui::Text("Post FX: %d passes culled, %.1f MB of targets (%.1f MB without aliasing)", post_fx_graph.num_culled,
+			post_fx_graph.memory / (1024.0 * 1024.0), post_fx_graph.memory_no_aliasing / (1024.0 * 1024.0));
+		for (auto it = post_fx_peak_memory.begin(); it != post_fx_peak_memory.end(); ++it)
+			ImGui::Text("  peak %s: %.1f MB", it->first.c_str(), it->second / (1024.0 * 1024.0));
+		ImGui::Checkbox("Tiled lights", &use_tiled_deferred);
+		int num_tiled = 0;
+		for (int i = 0; i < 32; ++i)
+			num_tiled += (tiled_lights_mask >> i) & 1;
+		ImGui::Text("Lights: %d in tiles, %d in their own pass", num_tiled, num_light_passes);
+		ImGui::Checkbox("Light volumes", &use_light_volumes);
+		ImGui::Text("Passes drawn with a volume: %d", num_volume_passes);
+		if (apply_irr)
+		{
+			ImGui::Checkbox("Apply trilinear interpolation irr", &apply_tri_irr);
+			if(ImGui::Button("Update Irr Cache", ImVec2(200.0, 20.0))) updateIrradianceCache(Scene::instance);
+			ImGui::Checkbox("Render Irradiance Probes", &render_probes);
+		}
+		ImGui::Checkbox("Show probes_text", &show_probes_text);
+		if (hdr) {
+			ImGui::SliderFloat("Average luminance", &average_lum, 0.0, 2.0);
+			ImGui::SliderFloat("White luminance", &lum_white, 0.0, 2.0);
+			ImGui::SliderFloat("Scale tonemap", &scale_tm, 0.001, 2.0);
+		}
+		ImGui::Combo("Blend", (int*)&blend_mode, "DITHERING\0FORWARD", 2);
+		ImGui::SliderFloat("Treshold intensity", &fx.treshold_intensity, 0, 10);
+		ImGui::SliderFloat("Bloom intensity", &fx.bloom_intensity, 0, 10);
+		ImGui::SliderFloat("focal intesity", &fx.focal_dist, 0, 5000);
+		ImGui::SliderFloat("min distance", &fx.min_distance, 0, 1000);
+		ImGui::SliderFloat("max distance", &fx.max_distance, 0, 1000);
+		ImGui::SliderFloat("DoF max level", &fx.dof_max_level, 1, FX_PYRAMID_LEVELS);
+	}
+}
+
+
+void GTR::Renderer::renderGBuffers(Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera)
+{
+	glClearColor(scene->background_color.x, scene->background_color.y, scene->background_color.z, 1.0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	GLState::enable(GL_DEPTH_TEST);
+	checkGLErrors();
+
+	if (scene->enviroment)
+		renderSkybox(scene->enviroment, camera);
+
+	updateFrameBlock(scene, camera);
+	renderCallsInstanced(eRenderMode::GBUFFERS, scene, rendercalls, camera, blend_mode == FORWARD_BLEND);
+}
+
+
+void GTR::Renderer::defineAndPosGridProbe(GTR::Scene* scene)
+{
+	//when computing the probes position�
+
+	//define the corners of the axis aligned grid
+	//this can be done using the boundings of our scene
+
+	//define how many probes you want per dimension -230, 36, -342 //500 433 460
+
+	//compute the vector from one corner to the other
+
+	//and scale it down according to the subdivisions
+	//we substract one to be sure the last probe is at end pos
+	irr_delta.x /= (irr_dim.x - 1);
+	irr_delta.y /= (irr_dim.y - 1);
+	irr_delta.z /= (irr_dim.z - 1);
+
+	//now delta give us the distance between probes in every axis
+
+	//lets compute the centers
+	//pay attention at the order at which we add them
+	for (int z = 0; z < irr_dim.z; ++z)
+		for (int y = 0; y < irr_dim.y; ++y)
+			for (int x = 0; x < irr_dim.x; ++x)
+			{
+				sProbe p;
+				p.local.set(x, y, z);
+
+				//index in the linear array
+				p.index = x + y * irr_dim.x + z * irr_dim.x * irr_dim.y;
+
+				//and its position
+				p.pos = irr_start_pos + irr_delta * Vector3(x, y, z);
+				probes.push_back(p);
+			}
+
+	if (!probes_texture)
+	{
+		int numProb = probes.size();
+		probes_texture = new Texture(
+			9, //9 coefficients per probe
+			numProb, //as many rows as probes
+			GL_RGB, //3 channels per coefficient
+			GL_FLOAT); //they require a high range
+	}
+}
+
+
+void Renderer::renderProbe(Vector3 pos, float size, float* coeffs)
+{
+	Camera* camera = Camera::current;
+	Shader* shader = Shader::Get("probe");
+	Mesh* mesh = sphere_mesh;
+
+	GLState::enable(GL_CULL_FACE);
+	GLState::disable(GL_BLEND);
+	GLState::enable(GL_DEPTH_TEST);
+
+	Matrix44 model;
+	model.setTranslation(pos.x, pos.y, pos.z);
+	model.scale(size, size, size);
+
+	shader->enable();
+	shader->setUniform(SID("u_viewprojection"), camera->viewprojection_matrix);
+	shader->setUniform(SID("u_camera_position"), camera->eye);
+	shader->setUniform(SID("u_model"), model);
+	shader->setUniform3Array(SID("u_coeffs"), coeffs, 9);
+
+	mesh->render(GL_TRIANGLES);
+
+}
+
+
+void Renderer::extractProbe(GTR::Scene* scene, sProbe& p) {
+	FloatImage images[6]; //here we will store the six views
+	Camera cam;
+
+	//set the fov to 90 and the aspect to 1
+	cam.setPerspective(90, 1, 0.1, 1000);
+
+	if (!irr_fbo) {
+		irr_fbo = new FBO();
+		irr_fbo->create(64, 64, 1, GL_RGB, GL_FLOAT, true, false, Texture::getFloatFormat(FLOAT_HALF, GL_RGB));
+	}
+
+	collectRenderCalls(scene, NULL);
+	//std::cout << renderCallList.size() << "\n";
+
+	//boxes of all the calls, every face only renders the ones inside its frustum
+	cull_boxes.clear();
+	for (int i = 0; i < renderCallList.size(); ++i)
+		cull_boxes.add(renderCallList[i].world_bounding);
+	cull_mask.resize(renderCallList.size());
+
+	for (int i = 0; i < 6; i++) //for every cubemap face
+	{
+		//compute camera orientation using defined vectors
+		Vector3 eye = p.pos;
+		Vector3 front = cubemapFaceNormals[i][2];
+		Vector3 center = p.pos + front;
+		Vector3 up = cubemapFaceNormals[i][1];
+		cam.lookAt(eye, center, up);
+		cam.enable();
+
+		probe_calls.clear();
+		if (renderCallList.size())
+			cam.testBoxesInFrustum(cull_boxes, &cull_mask[0]);
+		for (int j = 0; j < renderCallList.size(); ++j)
+			if (cull_mask[j])
+				probe_calls.push_back(renderCallList[j]);
+
+		//render the scene from this point of view
+		irr_fbo->bind();
+		renderForward(scene, probe_calls, &cam);
+		irr_fbo->unbind();
+
+		//read the pixels back and store in a FloatImage
+		images[i].fromTexture(irr_fbo->color_textures[0]);
+	}
+
+	//compute the coefficients given the six images
+	p.sh = computeSH(images, 1.0);
+}
+
+void GTR::Renderer::updateIrradianceCache(GTR::Scene* scene) {
+
+	//we must create the color information for the texture. because every SH are 27 floats in the RGB,RGB,... order, we can create an array of SphericalHarmonics and use it as pixels of the texture
+	SphericalHarmonics* sh_data = NULL;
+	sh_data = new SphericalHarmonics[ irr_dim.x * irr_dim.y * irr_dim.z ];
+
+	int numProbes = probes.size();
+	//now compute the coeffs for every probe
+	for (int iP = 0; iP < numProbes; ++iP)
+	{
+		extractProbe(scene, probes[iP]);
+		sh_data[iP] = probes[iP].sh;
+	}
+
+
+	//here we fill the data of the array with our probes in x,y,z order...
+	//now upload the data to the GPU
+	probes_texture->upload( GL_RGB, GL_FLOAT, false, (uint8*)sh_data);
+
+	////disable any texture filtering when reading
+	probes_texture->bind();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+	////always free memory after allocating it!!!
+	delete[] sh_data;
+	//extractProbe(scene, probe);
+}
+
+Texture* GTR::CubemapFromHDRE(const char* filename)
+{
+	HDRE* hdre = HDRE::Get(filename);
+	if (!hdre)
+		return NULL;
+
+	//the environment is only sampled and has no negative values, a shared exponent keeps the range in 4 bytes
+	unsigned int internal_format = Texture::getFloatFormat(FLOAT_SHARED_EXPONENT);
+
+	Texture* texture = new Texture();
+	if (hdre->getFacesf(0))
+	{
+		texture->createCubemap(hdre->width, hdre->height, (Uint8**)hdre->getFacesf(0),
+			hdre->header.numChannels == 3 ? GL_RGB : GL_RGBA, GL_FLOAT, true, internal_format);
+		for (int i = 1; i < hdre->levels; ++i)
+			texture->uploadCubemap(texture->format, texture->type, false,
+				(Uint8**)hdre->getFacesf(i), internal_format, i);
+	}
+	else
+		if (hdre->getFacesh(0))
+		{
+			texture->createCubemap(hdre->width, hdre->height, (Uint8**)hdre->getFacesh(0),
+				hdre->header.numChannels == 3 ? GL_RGB : GL_RGBA, GL_HALF_FLOAT, true, internal_format);
+			for (int i = 1; i < hdre->levels; ++i)
+				texture->uploadCubemap(texture->format, texture->type, false,
+					(Uint8**)hdre->getFacesh(i), internal_format, i);
+		}
+	return texture;
+}
+
+GTR::FX::FX() {
+	treshold_intensity = 1.0f;
+	bloom_intensity = 0.63f;
+
+	focal_dist = 461;
+	min_distance = 101.0f;
+	max_distance = 189.0f;
+	dof_max_level = 3.0f;
+
+	memset(pyramid, 0, sizeof(pyramid));
+
+	w = Application::instance->window_width;;
+	h = Application::instance->window_height;;
+}
+
+void GTR::FX::aa(Texture* input, Texture* output) {
+	setFX(AA, input, output);
+}
+
+void GTR::FX::downsample(Texture* input, Texture* output) {
+	setFX(DOWNSAMPLE, input, output);
+}
+
+void GTR::FX::upsample(Texture* input, Texture* base, Texture* output) {
+	setFX(UPSAMPLE, input, output, base);
+}
+
+void GTR::FX::bloomDof(Texture* input, Texture** levels, Texture* bloom, Texture* depth_buffer, Camera* camera, Texture* output) {
+	for (int i = 0; i < FX_PYRAMID_LEVELS; ++i)
+		pyramid[i] = levels[i];
+	setFX(BLOOM_DOF, input, output, bloom, depth_buffer, camera);
+}
+
+void GTR::FX::setFX(eFxMode fx, Texture* input, Texture* output, Texture* second_input, Texture* depth_buffer, Camera* camera)
+{
+	FBO* fbo = Texture::getGlobalFBO(output);
+	fbo->bind();
+
+		Mesh* quad = Mesh::getQuad();
+		Shader* sh;
+		switch (fx) {
+			case AA: sh = Shader::Get("AAFX"); break;
+			case DOWNSAMPLE: sh = Shader::Get("downsampleFX"); break;
+			case UPSAMPLE: sh = Shader::Get("upsampleFX"); break;
+			case BLOOM_DOF: sh = Shader::Get("bloomDofFX"); break;
+		}
+
+		GLState::disable(GL_DEPTH_TEST);
+		GLState::disable(GL_BLEND);
+
+		sh->enable();
+
+			sh->setTexture(SID("u_input"), input, 9);
+
+			switch (fx) {
+				case AA: 
+					sh->setUniform(SID("u_iViewportSize"), Vector2(1.0 / (float)w, 1.0 / (float)h));
+					sh->setUniform(SID("u_viewportSize"), Vector2((float)w, (float)h));
+					break;
+				case DOWNSAMPLE:
+					break;
+				case UPSAMPLE:
+					sh->setTexture(SID("u_base"), second_input, 10);
+					break;
+				case BLOOM_DOF:
+					sh->setTexture(SID("u_bloom"), second_input, 10);
+					sh->setTexture(SID("u_depth_buffer"), depth_buffer, 11);
+					sh->setTexture(SID("u_level1"), pyramid[0], 12);
+					sh->setTexture(SID("u_level2"), pyramid[1], 13);
+					sh->setTexture(SID("u_level3"), pyramid[2], 14);
+					sh->setTexture(SID("u_level4"), pyramid[3], 15);
+					sh->setTexture(SID("u_level5"), pyramid[4], 16);
+					sh->setUniform(SID("u_treshold_intensity"), treshold_intensity);
+					sh->setUniform(SID("u_bloom_intensity"), bloom_intensity);
+
+					Matrix44 inv_vp = camera->viewprojection_matrix;
+					inv_vp.inverse();
+					sh->setUniform(SID("u_inverse_viewprojection"), inv_vp);
+					sh->setUniform(SID("u_camera_pos"), camera->eye);
+					sh->setUniform(SID("u_camera_center"), camera->center);
+
+					sh->setUniform(SID("u_iRes"), Vector2(1.0 / (float)w, 1.0 / (float)h));
+					sh->setUniform(SID("u_dist_of_focus"), focal_dist);
+
+					sh->setUniform(SID("u_min_distance"), min_distance);
+					sh->setUniform(SID("u_max_distance"), max_distance);
+					sh->setUniform(SID("u_dof_max_level"), dof_max_level);
+					break;
+			}
+
+			quad->render(GL_TRIANGLES);
+
+		sh->disable();
+
+	fbo->unbind();
+
+}
@@ -1,238 +1,649 @@
-#pragma once
-#include "prefab.h"
-#include "fbo.h"
-
-#include "sphericalharmonics.h"
-
-//forward declarations
-class Camera;
-
-namespace GTR {
-
-	enum eRenderMode {
-		DEFAULT,
-		SHOW_TEXTURE,
-		SHOW_NORMAL,
-		SHOW_OCCLUSION,
-		SHOW_UVS,
-		SINGLE,
-		GBUFFERS
-	};
-
-	enum ePipelineMode {
-		FORWARD,
-		DEFERRED
-	};
-
-	enum eFxMode {
-		AA,
-		BLUR,
-		TRESHOLD,
-		BLOOM,
-		DOF
-	};
-
-	enum eBlendMode {
-		DITHERING,
-		FORWARD_BLEND
-	};
-
-	class Prefab;
-	class Material;
-
-	struct renderCall { //recuerda a�adir el tipo (prefab, ...)
-		Matrix44 model;
-		Mesh* mesh;
-		Material* material;
-		float distance_to_cam;
-	};
-
-
-	class SSAOFX {
-	public:
-		float intensity;
-
-		std::vector<Vector3> points;
-
-		SSAOFX();
-
-		void blurTexture(Texture* input, Texture* output);
-		void apply(Texture* depth_buffer, Texture* normal_buffer, Camera* cam, Texture* output);
-	};
-
-	class FX {
-	public:
-
-		int w;
-		int h;
-
-		float treshold_intensity;
-		float bloom_intensity;
-		float min_distance;
-		float max_distance;
-		float focal_dist;
-
-		bool horizontal = false;
-
-		FX();
-
-		void treshold(Texture* input, Texture* output);
-		void blur(Texture* input, Texture* output);
-		void bloom(Texture* input_base, Texture* input_blurred, Texture* output);
-		void aa(Texture* input, Texture* output);
-		void dof(Texture* input, Texture* input_blurred, Texture* depth_buffer, Camera* camera, Texture* output);
-		void setFX(eFxMode fx, Texture* input, Texture* output, Texture* second_input = NULL, Texture* depth_buffer = NULL, Camera* camera = NULL);
-	};
-
-	//struct to store probes
-	struct sProbe {
-		Vector3 pos; //where is located
-		Vector3 local; //its ijk pos in the matrix
-		int index; //its index in the linear array
-		SphericalHarmonics sh; //coeffs
-	};
-
-
-	std::vector<Vector3> generateSpherePoints(int num, float radius, bool hemi);
-	// This class is in charge of rendering anything in our system.
-	// Separating the render from anything else makes the code cleaner
-	class Renderer
-	{
-
-	public:
-
-		int w;
-		int h;
-		//add here your functions
-		//...
-		FBO fbo;
-		FBO gbuffers_fbo;
-		FBO decals_fbo;
-		FBO* irr_fbo;
-
-		bool use_only_FXAA = false;
-		bool use_bloom_dof = true;
-		bool use_volumetric = true;
-		bool use_reflections = true;
-		bool updateIrradianceOnce = true;
-		bool rendering_shadowmap;
-
-		eRenderMode render_mode;
-		ePipelineMode pipeline_mode;
-		eBlendMode blend_mode;
-
-		eLightType light_types[5];
-
-		Vector3 light_position[5];
-		Vector3 light_target[5];
-		Vector3 light_color[5];
-
-		float light_intensity[5];
-		float light_maxdists[5];
-		float light_coscutoff[5];
-		float light_spotexponent[5];
-
-		Vector3 light_vector[5];
-
-		bool hdr = true;
-		bool show_fbo = false;
-		bool show_gbuffers = false;
-		bool showCameraDirectional = false;
-		bool show_ao_buffer = false;
-		bool show_depthfbo = false;
-		bool apply_ssao = true;
-		bool show_irr_fbo = false;
-		bool apply_irr = true;
-		bool apply_tri_irr = true;
-		bool show_probes_text = false;
-		bool render_probes = false;
-
-		float average_lum;
-		float lum_white;
-		float scale_tm;
-
-		Texture* ao_buffer = NULL;
-		Texture* ao_blur_buffer = NULL;
-		Texture* probes_texture = NULL;
-
-		Texture* fx_blur_buffer = NULL;
-		Texture* fx_threshold_buffer = NULL;
-		Texture* fx_bloom_buffer = NULL;
-		Texture* fx_aa_buffer = NULL;
-		Texture* fx_dof_buffer = NULL;
-		Texture* fx_dof_blurred_buffer = NULL;
-		Texture* fx_dof_blurred_buffer_2 = NULL;
-
-		SSAOFX ssao;
-
-		FX fx;
-
-		Matrix44 previous_vp;
-
-		std::vector<sProbe> probes;
-
-		Vector3 irr_start_pos;
-		Vector3 irr_end_pos;
-		Vector3 irr_dim;
-		Vector3 irr_delta;
-		float irr_normal_dist;
-
-		Renderer();
-
-		std::vector<renderCall> renderCallList;
-		//renders several elements of the scene
-
-		void render(GTR::Scene* scene, Camera* camera);
-
-		void renderFinalFBO(GTR::Scene* scene, Camera* camera);
-
-		void collectRenderCalls(GTR::Scene* scene, Camera* camera);
-
-		void renderScene(GTR::Scene* scene, Camera* camera, ePipelineMode pipmode);
-
-		void renderForward(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera);
-
-		void renderDeferred(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera);
-
-		//to render a whole prefab (with all its nodes)
-		void getRenderCallsFromPrefabs(const Matrix44& model, GTR::Prefab* prefab, Camera* camera);
-
-		//to render one node from the prefab and its children
-		void getRenderCallsFromNode(const Matrix44& prefab_model, GTR::Node* node, Camera* camera);
-
-		//to render one mesh given its material and transformation matrix
-		void renderMeshWithMaterial(eRenderMode mode, GTR::Scene* scene, const Matrix44 model, Mesh* mesh, GTR::Material* material, Camera* camera);
-
-		void renderSceneShadowmaps(GTR::Scene* scene);
-
-		void renderMeshInShadowMap(Material* material, Camera* camera, Matrix44 model, Mesh* mesh, Texture* texture);
-
-		void renderGBuffers(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera);
-
-		void renderToFbo(GTR::Scene* scene, GTR::LightEntity* light);
-		//void renderToFbo(GTR::Scene* scene, Camera* camera);
-		void renderInMenu();
-
-		void defineAndPosGridProbe(GTR::Scene* scene);
-
-		void renderProbe(Vector3 pos, float size, float* coeffs);
-		void extractProbe(GTR::Scene* scene, sProbe& p);
-
-		void updateIrradianceCache(GTR::Scene* scene);
-
-		void createIrradianceMap();
-		void computeVolumetric(Camera* camera, Texture* depth_texture, Scene* scene);
-
-		void renderDecalls(GTR::Scene* scene, Camera* camera);
-
-		void renderSkybox(Texture* skybox, Camera* camera);
-
-		void view_gbuffers(Camera* camera);
-		void renderFinalFBO(FBO* gbuffers_fbo, Camera* camera, GTR::Scene* scene, bool hdr, Texture* ao_buffer, std::vector <renderCall>& rendercalls);
-		void setUniformsLight(LightEntity* light, Camera* camera, GTR::Scene* scene, Texture* ao_buffer, Shader* shader, bool hdr, FBO* gbuffers_fbo, bool first_iter);
-
-	};
-
-	Texture* CubemapFromHDRE(const char* filename);
-
-};
+#pragma once
+#include "prefab.h"
+#include "fbo.h"
+#include "bvh.h"
+#include "decals.h"
+#include "lightclusters.h"
+#include "framegraph.h"
+#include "shadowatlas.h"
+#include "culling.h"
+#include "occlusion.h"
+#include "ubo.h"
+#include "mesharena.h"
+#include "shader.h"
+
+#include "sphericalharmonics.h"
+
+#include <cstdint>
+#include <functional>
+
+//forward declarations
+class Camera;
+
+namespace GTR {
+
+	enum eRenderMode {
+		DEFAULT,
+		SHOW_TEXTURE,
+		SHOW_NORMAL,
+		SHOW_OCCLUSION,
+		SHOW_UVS,
+		SINGLE,
+		GBUFFERS,
+		CLUSTERED	//DEFAULT and SINGLE with all the lights of the cluster in one pass
+	};
+
+	const int NUM_RENDER_MODES = CLUSTERED + 1;
+
+	enum ePipelineMode {
+		FORWARD,
+		DEFERRED
+	};
+
+	enum eFxMode {
+		AA,
+		DOWNSAMPLE,
+		UPSAMPLE,
+		BLOOM_DOF
+	};
+
+	enum eBlendMode {
+		DITHERING,
+		FORWARD_BLEND
+	};
+
+	class Prefab;
+	class Material;
+	class BaseEntity;
+
+	struct renderCall { //recuerda a�adir el tipo (prefab, ...)
+		Matrix44 model;
+		Mesh* mesh;
+		Material* material;
+		BoundingBox world_bounding;
+		BaseEntity* entity;	//owner, to know in which layer of the cached shadowmaps it goes
+		float distance_to_cam;
+		int lod; //level of detail of the mesh, 0 is the full mesh
+	};
+
+	//scratch buffers used while collecting the render calls, one per task
+	struct sCollectBuffers {
+		BoxArraySoA boxes;
+		std::vector<unsigned char> mask;
+		std::vector<Matrix44> models;
+		std::vector<int> nodes;
+		std::vector<renderCall> calls; //output of the task
+	};
+
+	//consecutive render calls that share mesh, material and lod, drawn with one instanced call
+	struct sInstanceGroup {
+		Mesh* mesh;
+		Material* material;
+		int lod;
+		int first;	//first model in Renderer::instance_models
+		int count;
+	};
+
+	//uniform blocks, same layout (std140) as the blocks declared in the shader atlas
+	const int MAX_BLOCK_LIGHTS = 32;
+	const int MATERIALS_PER_BLOCK = 256;
+
+	//shadowmaps of all the lights share one atlas, the tile of every light depends on how big it looks
+	const int SHADOW_ATLAS_SIZE = 4096;
+	const int MAX_SHADOW_TILE_SIZE = 2048;
+
+	//the first directional light with shadows uses cascades fitted to slices of the camera frustum
+	const int MAX_CASCADES = 4;
+	const int CASCADE_TILE_SIZE = 1024;
+
+	//size in pixels of the screen tiles of the tiled deferred lighting
+	const int LIGHT_TILE_SIZE = 16;
+
+	struct sFrameBlock {
+		Matrix44 viewprojection;
+		Vector3 camera_position;
+		float time;
+		Vector3 ambient_light;
+		int dithering;
+	};
+
+	struct sLightBlock {
+		Vector4 position[MAX_BLOCK_LIGHTS];		//w is the type
+		Vector4 color[MAX_BLOCK_LIGHTS];		//w is the intensity
+		Vector4 direction[MAX_BLOCK_LIGHTS];	//w is the max distance
+		Vector4 params[MAX_BLOCK_LIGHTS];		//cos cutoff, spot exponent, shadow bias, cast shadows
+		Vector4 shadow_rect[MAX_BLOCK_LIGHTS];	//tile in the shadow atlas, offset and size in uv
+		Matrix44 shadow_viewproj[MAX_BLOCK_LIGHTS];
+		Matrix44 cascade_viewproj[MAX_CASCADES];
+		Vector4 cascade_rect[MAX_CASCADES];
+		int num_lights;
+		int cascade_light;	//index in the block, -1 if no light has cascades
+		int num_cascades;
+		int padding;
+	};
+
+	//the scenes with more lights than a block fill several of them, aligned to 256 bytes in light_ubo
+	//(the biggest GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT of the drivers) so any page can be bound with bindRange
+	const int LIGHT_PAGE_SIZE = (sizeof(sLightBlock) + 255) / 256 * 256;
+
+	struct sMaterialData {
+		Vector4 color;
+		Vector3 emissive_factor;
+		float alpha_cutoff;
+		float metallic_factor;
+		float roughness_factor;
+		float padding[2];
+	};
+
+	//casters drawn in a shadowmap, the static ones are cached between frames and the dynamic ones drawn over them
+	enum eCasterLayer {
+		ALL_CASTERS,
+		STATIC_CASTERS,
+		DYNAMIC_CASTERS
+	};
+
+	//an entity is a dynamic caster until it stays this number of frames without changes
+	const int DYNAMIC_CASTER_FRAMES = 30;
+
+	struct sCasterState {
+		unsigned int version;
+		int changed_frame;		//last frame its version changed
+		int seen_frame;			//last frame it was in the scene
+		bool dynamic;
+		bool has_bounds;		//false if hidden or without prefab
+		BoundingBox bounds;		//world bounds of the last version
+	};
+
+	//static layer of a shadowmap, kept in the same tile of a copy of the atlas
+	struct sShadowCache {
+		Matrix44 viewprojection;
+		sShadowTile tile;
+		int frame;			//last frame it was used, after a gap the tile could have been used by other light
+		bool has_dynamic;	//the tile of the atlas has dynamic casters over the static layer
+	};
+
+	//tile size wanted by a light with shadows this frame
+	struct sShadowRequest {
+		LightEntity* light;
+		float importance;	//part of the screen covered by the lit volume, 1 for directional lights
+		int size;
+	};
+
+	//packed sort key of a render call and its position in the list
+	struct sRenderKey {
+		uint64_t key;
+		int index;
+	};
+
+	class Renderer;
+	class Scene;
+
+	//render calls of one view kept between frames
+	//only the entities that changed are evaluated again and their calls merged in the sorted list
+	class RenderListCache {
+	public:
+		struct sCachedEntity {
+			BaseEntity* entity;
+			unsigned int version;			//entity version when its calls were generated
+			std::vector<renderCall> calls;	//calls of this entity inside the view
+		};
+
+		//where a call is stored
+		struct sCallRef {
+			int entity;
+			int call;
+		};
+
+		std::vector<sCachedEntity> entities;
+		std::vector<sCallRef> refs;
+		std::vector<sRenderKey> keys;	//sorted, the index points to refs
+		std::vector<renderCall> calls;	//final list in the order of keys
+
+		Matrix44 viewprojection;
+		int material_version;
+		bool valid;
+		int frame;	//last frame of the renderer it was used in
+
+		//stats of the last update
+		int num_evaluated;
+		bool rebuilt;
+
+		RenderListCache();
+
+		void invalidate() { valid = false; }
+
+		//returns the sorted calls of the scene seen from this camera
+		std::vector<renderCall>& update(Renderer* renderer, Scene* scene, Camera* camera);
+
+	private:
+		std::vector<int> changed;
+		std::vector<char> dirty;
+		std::vector<sRenderKey> new_keys;
+		std::vector<sRenderKey> temp_keys;
+		std::vector<sRenderKey> merged_keys;
+
+		void rebuild(Renderer* renderer, Scene* scene, Camera* camera);
+		void updateChanged(Renderer* renderer, Scene* scene, Camera* camera);
+		void addEntityKeys(Renderer* renderer, int entity_index, Camera* camera, std::vector<sRenderKey>& output);
+		void gatherCalls();
+	};
+
+
+	class SSAOFX {
+	public:
+		float intensity;
+
+		std::vector<Vector3> points;
+
+		SSAOFX();
+
+		void blurTexture(Texture* input, Texture* output);
+		void apply(Texture* depth_buffer, Texture* normal_buffer, Camera* cam, Texture* output);
+	};
+
+	//levels of the bloom and DoF pyramid, from half to 1/32 of the screen
+	const int FX_PYRAMID_LEVELS = 5;
+
+	class FX {
+	public:
+
+		int w;
+		int h;
+
+		float treshold_intensity;
+		float bloom_intensity;
+		float min_distance;
+		float max_distance;
+		float focal_dist;
+		float dof_max_level;	//pyramid level used by the pixels farthest from the focus
+
+		Texture* pyramid[FX_PYRAMID_LEVELS];	//levels read by the DoF
+
+		FX();
+
+		void aa(Texture* input, Texture* output);
+		//dual filter pyramid, every level is half the size of the previous one
+		void downsample(Texture* input, Texture* output);
+		//blurs the smaller level and blends it with the level of the output size
+		void upsample(Texture* input, Texture* base, Texture* output);
+		//bloom from the top of the upsampled chain, DoF picking a level of the pyramid per pixel
+		void bloomDof(Texture* input, Texture** levels, Texture* bloom, Texture* depth_buffer, Camera* camera, Texture* output);
+		void setFX(eFxMode fx, Texture* input, Texture* output, Texture* second_input = NULL, Texture* depth_buffer = NULL, Camera* camera = NULL);
+	};
+
+	//struct to store probes
+	struct sProbe {
+		Vector3 pos; //where is located
+		Vector3 local; //its ijk pos in the matrix
+		int index; //its index in the linear array
+		SphericalHarmonics sh; //coeffs
+	};
+
+
+	std::vector<Vector3> generateSpherePoints(int num, float radius, bool hemi);
+	// This class is in charge of rendering anything in our system.
+	// Separating the render from anything else makes the code cleaner
+	class Renderer
+	{
+
+	public:
+
+		int w;
+		int h;
+		//add here your functions
+		//...
+		FBO fbo;
+		FBO gbuffers_fbo;
+		FBO decals_fbo;		//only the albedo of the gbuffers, the decals are drawn on it in place
+		FBO* irr_fbo;
+
+		//tiled deferred: one texel per tile with the mask of the lights of the block that touch it
+		bool use_tiled_deferred = true;
+		FBO light_tiles_fbo;
+		unsigned int tiled_lights_mask = 0;	//lights shaded in the tiled pass this frame
+		int num_light_passes = 0;			//passes of the per light fallback this frame
+
+		//point and spot lights of the fallback passes only shade the pixels inside their volume
+		bool use_light_volumes = true;
+		int num_volume_passes = 0;
+
+		bool use_only_FXAA = false;
+		bool use_bloom_dof = true;
+		bool use_volumetric = true;
+		bool use_reflections = true;
+		bool updateIrradianceOnce = true;
+		bool rendering_shadowmap;
+
+		ShadowAtlas shadow_atlas;
+		std::vector<sShadowRequest> shadow_requests;
+		int num_shadow_tiles = 0;	//shadowmaps rendered this frame
+
+		//cascaded shadowmaps of the directional light, the cameras are kept so every cascade has its own culling cache
+		bool use_cascades = true;
+		int num_cascades = 4;
+		float cascades_distance = 2000.0;	//the last cascade ends here or at the camera far plane
+		float cascades_lambda = 0.75;		//blend between logarithmic (1) and uniform (0) splits
+		LightEntity* cascade_light = NULL;
+		int num_active_cascades = 0;		//cascades that got a tile this frame
+		sShadowTile cascade_tiles[MAX_CASCADES];
+		Camera cascade_cameras[MAX_CASCADES];
+		float cascade_splits[MAX_CASCADES + 1];
+
+		//static shadow caching, the shadowmaps are only rendered again when the static casters inside change
+		bool use_shadow_cache = true;
+		FBO static_shadow_fbo;
+		eCasterLayer caster_layer = ALL_CASTERS;	//casters drawn by renderScene while rendering_shadowmap
+		int shadow_frame = 0;
+		std::map<BaseEntity*, sCasterState> caster_states;
+		std::map<Camera*, sShadowCache> shadow_caches;
+		std::vector<BoundingBox> static_changes;	//places where the static casters changed this frame
+		std::vector<BoundingBox> dynamic_bounds;
+		std::vector<renderCall> layer_calls;
+		int num_shadow_reused = 0;		//tiles that kept the static layer this frame
+		int num_shadow_rerendered = 0;	//tiles with the static layer rendered again
+		int num_shadow_dynamic = 0;		//tiles with dynamic casters drawn over the static layer
+		bool check_shadow_cache = false;	//reads back the tiles to verify the dynamic pass keeps the static depth (slow)
+		int num_shadow_lost_texels = 0;		//texels of the static layer that got further after the dynamic pass, must be 0
+		std::vector<float> shadow_check_depth;
+
+		int num_decals_drawn = 0;		//decals inside the frustum this frame
+
+		eRenderMode render_mode;
+		ePipelineMode pipeline_mode;
+		eBlendMode blend_mode;
+
+		bool hdr = true;
+		bool show_fbo = false;
+		bool show_gbuffers = false;
+		bool showCameraDirectional = false;
+		bool show_ao_buffer = false;
+		bool show_depthfbo = false;
+		bool apply_ssao = true;
+		bool show_irr_fbo = false;
+		bool apply_irr = true;
+		bool apply_tri_irr = true;
+		bool show_probes_text = false;
+		bool render_probes = false;
+		bool use_bvh = true;
+		bool use_radix_sort = true;
+		bool use_parallel_collect = true;
+		bool use_render_cache = true;
+		bool use_occlusion = true;
+		int max_occluders = 16;
+		int max_occluder_triangles = 20000;
+		bool use_lods = true;
+		bool use_instancing = true;
+		bool use_multidraw = true;
+		float lod_max_error = 1.0f; //projected error allowed when choosing a simplified mesh, around one pixel
+
+		float average_lum;
+		float lum_white;
+		float scale_tm;
+
+		Texture* ao_buffer = NULL;
+		Texture* ao_blur_buffer = NULL;
+		Texture* probes_texture = NULL;
+
+		//post effects, declared every frame, the targets come from the pool of the graph
+		FrameGraph post_fx_graph;
+		std::map<std::string, size_t> post_fx_peak_memory;	//by size and effects enabled
+
+		//the next frame is rendered twice, with every float target in full precision and with the policy
+		bool compare_precision = false;
+		float precision_max_difference = -1.0;	//in display units (0..1) after tonemap, negative if not compared yet
+		float precision_mean_difference = 0.0;
+		size_t precision_memory[2] = { 0, 0 };	//bytes of the screen targets, full precision and policy
+		std::vector<float> precision_pixels[2];
+
+		SSAOFX ssao;
+
+		FX fx;
+
+		Matrix44 previous_vp;
+
+		std::vector<sProbe> probes;
+
+		Vector3 irr_start_pos;
+		Vector3 irr_end_pos;
+		Vector3 irr_dim;
+		Vector3 irr_delta;
+		float irr_normal_dist;
+
+		//programs used to draw the meshes in every mode, [mode][instanced]
+		//resolved to handles once so choosing one per draw does not touch strings
+		ShaderHandle mesh_shaders[NUM_RENDER_MODES][2];
+		Mesh* sphere_mesh;
+		Mesh* cone_mesh;
+
+		Renderer();
+
+		std::vector<renderCall> renderCallList;
+
+		//hierarchy used to cull the prefab nodes of the scene
+		SceneBVH bvh;
+		//subtrees of the bvh culled at the same time and their visible items
+		std::vector<int> bvh_roots;
+		std::vector<SceneBVH::sCullScratch> bvh_tasks;
+
+		//decals of the scene, culled and drawn in one instanced call
+		DecalRenderer decals;
+
+		//scratch buffers for the batch frustum test
+		BoxArraySoA cull_boxes;
+		std::vector<unsigned char> cull_mask;
+		std::vector<renderCall> probe_calls;
+
+		//buffers of the serial and the parallel collection
+		sCollectBuffers collect_buffers;
+		std::vector<sCollectBuffers> collect_tasks;
+
+		//persistent render list of every view (main camera and light cameras)
+		//the ones not used in the last frame are dropped, their camera may not exist anymore
+		std::map<Camera*, RenderListCache> render_caches;
+		int render_frame = 0;
+
+		//software occlusion culling of the main view
+		OcclusionBuffer occlusion;
+		std::vector<int> occluder_candidates;
+		std::vector<unsigned char> occlusion_mask;
+		std::vector<renderCall> occlusion_calls;
+		int occlusion_tested = 0;
+		int occlusion_culled = 0;
+
+		//instanced draws of the current pass
+		std::vector<sInstanceGroup> instance_groups;
+		std::vector<Matrix44> instance_models;
+		int instanced_calls = 0;	//render calls drawn as instances this frame
+		int instanced_draws = 0;	//draw calls used for them
+		std::vector<sMultiDrawItem> multi_draw_items;
+		int multidraw_groups = 0;	//instance groups drawn inside a multi draw this frame
+		int multidraws = 0;
+
+		//uniform buffers shared by all the programs
+		UBO frame_ubo;
+		UBO light_ubo;
+		UBO material_ubo;
+		UBO cluster_ubo;
+		sFrameBlock frame_block;
+		std::vector<sLightBlock> light_pages;	//block of every MAX_BLOCK_LIGHTS lights of the scene, in the same order
+		int light_page = -1;	//page of light_ubo bound now
+		std::vector<sMaterialData> materials_data;	//copy of material_ubo, indexed by Material::block_index
+		int material_page = -1;	//page of material_ubo bound now
+
+		//clustered forward: the lit modes draw every mesh once per page of the light block, the shadows are read from the atlas
+		bool use_clustered_forward = true;
+		LightClusters light_clusters;
+
+		//keys used to sort the render calls
+		std::vector<sRenderKey> render_keys;
+		std::vector<sRenderKey> render_keys_temp;
+		std::vector<renderCall> sorted_calls;
+
+		//renders several elements of the scene
+
+		void render(GTR::Scene* scene, Camera* camera);
+
+		void renderFinalFBO(GTR::Scene* scene, Camera* camera);
+
+		void collectRenderCalls(GTR::Scene* scene, Camera* camera);
+
+		//loops the compiled prefab of every entity
+		void collectRenderCallsCompiled(GTR::Scene* scene, Camera* camera);
+
+		//same as collectRenderCallsCompiled but splitting the entities between the worker threads
+		//the result is the same as the serial version
+		void collectRenderCallsParallel(GTR::Scene* scene, Camera* camera);
+
+		//calls func for every entity splitting them between the worker threads, returns the number of tasks used
+		//entities of the same task are processed in order and share the same buffers
+		int processEntities(GTR::Scene* scene, const std::function<void(int, sCollectBuffers&)>& func);
+		//compiles the new prefabs and applies the nodes edited since the last call (node->dirty), from the main thread
+		void updatePrefabs(GTR::Scene* scene);
+
+		//adds the render calls of one entity to output
+		void collectEntityRenderCalls(BaseEntity* ent, Camera* camera, sCollectBuffers& buffers, std::vector<renderCall>& output);
+
+		//walks every prefab node of every entity
+		void collectRenderCallsRecursive(GTR::Scene* scene, Camera* camera);
+
+		//walks the bvh accepting or rejecting whole subtrees
+		void collectRenderCallsBVH(GTR::Scene* scene, Camera* camera);
+		//culls the subtrees of the bvh in the threads, the calls of every task are in collect_tasks
+		//in the same order as the items in bvh_tasks, returns the number of tasks
+		int cullBVH(GTR::Scene* scene, Camera* camera);
+
+		//compares the ways of collecting render calls and prints the times
+		void benchmarkCulling(GTR::Scene* scene, Camera* camera, int iterations);
+
+		//returns the cached list of the view updating only what changed
+		std::vector<renderCall>& getCachedRenderCalls(GTR::Scene* scene, Camera* camera);
+
+		//draws the biggest opaque calls as occluders in the cpu depth buffer and removes the calls hidden behind them
+		std::vector<renderCall>& applyOcclusionCulling(std::vector<renderCall>& calls, Camera* camera);
+
+		//times the occlusion culling of the current view with and without threads
+		void benchmarkOcclusion(GTR::Scene* scene, Camera* camera, int iterations);
+
+		//builds the packed key used to sort one render call
+		uint64_t computeSortKey(const renderCall& rc, Camera* camera);
+
+		//sorts renderCallList by state and depth
+		void sortRenderCalls(Camera* camera);
+
+		//compares std::sort with compareNodes against the radix sort of the keys
+		void benchmarkSort(Camera* camera, int iterations);
+
+		//the float targets take the formats of the precision policy, see Texture::getFloatFormat
+		void createScreenTargets(int w, int h);
+		size_t getScreenTargetsMemory();
+		void comparePrecision(GTR::Scene* scene, Camera* camera);
+
+		//compares the scalar box test against the SIMD batch versions
+		void benchmarkFrustumTest(GTR::Scene* scene, Camera* camera, int iterations);
+
+		void renderScene(GTR::Scene* scene, Camera* camera, ePipelineMode pipmode);
+
+		void renderForward(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera);
+
+		void renderDeferred(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera);
+		//declares the effects applied to fbo and the tonemap to the screen, the unused ones are culled
+		void buildPostFXGraph(Camera* camera, int w, int h);
+
+		//to render a whole prefab (with all its nodes)
+		void getRenderCallsFromPrefabs(BaseEntity* entity, GTR::Prefab* prefab, Camera* camera, sCollectBuffers& buffers, std::vector<renderCall>& output);
+
+		//to render one node from the prefab and its children
+		void getRenderCallsFromNode(BaseEntity* entity, GTR::Node* node, Camera* camera);
+
+		//coarsest level of detail of the mesh whose error projected on screen is below lod_max_error
+		int selectLOD(Mesh* mesh, const Matrix44& model, const BoundingBox& world_bounding, Camera* camera);
+
+		//groups the sorted calls that can be drawn together, blended calls are never grouped to keep their order
+		void buildInstanceGroups(std::vector<renderCall>& calls, bool skip_blended);
+
+		//renders the calls grouping the repeated meshes in instanced draws
+		//consecutive groups with the same material and arena are drawn with one multi draw
+		void renderCallsInstanced(eRenderMode mode, GTR::Scene* scene, std::vector<renderCall>& calls, Camera* camera, bool skip_blended);
+
+		//uploads the camera, time and ambient of the pass that is going to start
+		void updateFrameBlock(GTR::Scene* scene, Camera* camera);
+
+		//uploads all the lights, done once per frame after the shadowmaps are rendered
+		void updateLightBlock(GTR::Scene* scene);
+		//binds the page of the light block with the lights of that page, u_light_index is the position in it
+		void useLightPage(int page);
+
+		//assigns the lights of the bound page to the clusters of the camera and uploads them, after updateLightBlock
+		void updateClusterBlock(GTR::Scene* scene, Camera* camera);
+
+		//gives a slot to every material of the scene and uploads them all at once, called after loading it
+		void uploadMaterialBlocks(GTR::Scene* scene);
+		//uploads the material if it was edited (or created after the load), binds its page and sets its index in the shader
+		void useMaterialBlock(Shader* shader, GTR::Material* material);
+
+		//to render one mesh given its material and transformation matrix
+		//with instances the model is ignored and the mesh is drawn once for every matrix
+		//with groups all of them are drawn together, their meshes must share the arena
+		void renderMeshWithMaterial(eRenderMode mode, GTR::Scene* scene, const Matrix44 model, Mesh* mesh, GTR::Material* material, Camera* camera, int lod = 0, const Matrix44* instances = NULL, int num_instances = 0, const sInstanceGroup* groups = NULL, int num_groups = 0);
+
+		//renders the shadowmap of every light that got a tile in the atlas
+		void renderSceneShadowmaps(GTR::Scene* scene, Camera* camera);
+		//chooses the tile of every light, the less important ones get smaller tiles when there is no room
+		void assignShadowTiles(GTR::Scene* scene, Camera* camera);
+		float getShadowImportance(LightEntity* light, Camera* camera);
+		void assignCascadeTiles();
+		void fitCascades(Camera* camera);
+
+		//classifies the casters in static and dynamic and collects where the static ones changed
+		void updateCasterStates(GTR::Scene* scene);
+		bool getEntityBounds(BaseEntity* entity, BoundingBox& bounds);
+		//renders a shadowmap in its tile of the atlas, reusing the static layer when nothing changed in it
+		void renderShadowTile(GTR::Scene* scene, Camera* camera, const sShadowTile& tile);
+		void readShadowTileDepth(const sShadowTile& tile, std::vector<float>& depth);
+		std::vector<renderCall>& filterCasterLayer(std::vector<renderCall>& calls);
+
+		void renderMeshInShadowMap(Material* material, Camera* camera, Matrix44 model, Mesh* mesh, Texture* texture, int lod = 0, const Matrix44* instances = NULL, int num_instances = 0, const sInstanceGroup* groups = NULL, int num_groups = 0);
+		//the draw call of the two above, with the shader already enabled
+		void drawGeometry(Mesh* mesh, int lod, const Matrix44* instances, int num_instances, const sInstanceGroup* groups, int num_groups);
+
+		void renderGBuffers(GTR::Scene* scene, std::vector <renderCall>& rendercalls, Camera* camera);
+
+		void renderToFbo(GTR::Scene* scene, GTR::LightEntity* light);
+		//void renderToFbo(GTR::Scene* scene, Camera* camera);
+		void renderInMenu();
+
+		void defineAndPosGridProbe(GTR::Scene* scene);
+
+		void renderProbe(Vector3 pos, float size, float* coeffs);
+		void extractProbe(GTR::Scene* scene, sProbe& p);
+
+		void updateIrradianceCache(GTR::Scene* scene);
+
+		void createIrradianceMap();
+		void computeVolumetric(Camera* camera, Texture* depth_texture, Scene* scene);
+
+		void renderDecalls(GTR::Scene* scene, Camera* camera);
+
+		void renderSkybox(Texture* skybox, Camera* camera);
+
+		void view_gbuffers(Camera* camera);
+		void renderFinalFBO(FBO* gbuffers_fbo, Camera* camera, GTR::Scene* scene, bool hdr, Texture* ao_buffer, std::vector <renderCall>& rendercalls);
+		void setUniformsLight(LightEntity* light, Camera* camera, GTR::Scene* scene, Texture* ao_buffer, Shader* shader, bool hdr, FBO* gbuffers_fbo, bool first_iter);
+		//uniforms of the deferred shader that do not depend on the light
+		void setDeferredUniforms(Camera* camera, GTR::Scene* scene, Texture* ao_buffer, Shader* shader, bool hdr, FBO* gbuffers_fbo, bool first_iter);
+
+		//lights that can be shaded in the tiled pass, all the ones in the block since the shadowmaps share the atlas
+		unsigned int getTiledLightsMask(GTR::Scene* scene);
+		//fills light_tiles_fbo culling the lights against the depth bounds of every tile
+		void computeLightTiles(Camera* camera, FBO* gbuffers_fbo);
+
+		//proxy mesh and model that enclose the area lit by a point or spot light
+		Mesh* getLightVolume(LightEntity* light, Matrix44& model);
+		//marks in the stencil the pixels whose geometry is inside the volume
+		void markLightVolume(Mesh* volume, const Matrix44& model, Camera* camera);
+
+	};
+
+	Texture* CubemapFromHDRE(const char* filename);
+
+};
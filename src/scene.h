@@ -1,121 +1,148 @@
-#ifndef SCENE_H
-#define SCENE_H
-
-#include "framework.h"
-#include "fbo.h"
-#include "camera.h"
-#include <string>
-
-//forward declaration
-class cJSON;
-
-//our namespace
-namespace GTR {
-
-	enum eEntityType {
-		NONE = 0,
-		PREFAB = 1,
-		LIGHT = 2,
-		CAMERA = 3,
-		REFLECTION_PROBE = 4,
-		DECAL = 5
-	};
-
-	enum eLightType {
-		POINT = 0,
-		SPOT = 1,
-		DIRECTIONAL = 2
-	};
-
-	class Scene;
-	class Prefab;
-
-	//represents one element of the scene (could be lights, prefabs, cameras, etc)
-	class BaseEntity
-	{
-	public:
-		Scene* scene;
-		std::string name;
-		eEntityType entity_type;
-		Matrix44 model;
-		bool visible;
-		BaseEntity() { entity_type = NONE; visible = true; }
-		virtual ~BaseEntity() {}
-		virtual void renderInMenu();
-		virtual void configure(GTR::Scene* scene, cJSON* json) {}
-	};
-
-	//represents one prefab in the scene
-	class PrefabEntity : public GTR::BaseEntity
-	{
-	public:
-		std::string filename;
-		Prefab* prefab;
-
-		PrefabEntity();
-		virtual void renderInMenu();
-		virtual void configure(GTR::Scene* scene, cJSON* json);
-	};
-
-	class LightEntity : public GTR::BaseEntity
-	{
-	public:
-		Vector3 color;
-		Vector3 target;
-		float intensity;
-		eLightType light_type;
-		float max_distance;
-		float cone_angle;
-		float spot_exponent;
-		float area_size;
-
-		Camera camera;
-		FBO* fbo;
-		float shadow_bias;
-		bool cast_shadows;
-
-		LightEntity();
-
-		virtual void configure(GTR::Scene* scene, cJSON* json);
-		virtual void renderInMenu();
-		void setLightUniforms(Shader* shader, bool useshadowmap);
-
-	};
-
-	class DecalEntity : public GTR::BaseEntity {
-	public:
-		Texture* albedo;
-
-		DecalEntity();
-		virtual void configure(GTR::Scene* scene, cJSON* json);
-	};
-
-
-	//contains all entities of the scene
-	class Scene
-	{
-	public:
-		static Scene* instance;
-
-		Texture* enviroment = NULL;
-
-		Vector3 background_color;
-		Vector3 ambient_light;
-		std::vector<LightEntity*> lights;
-		Camera main_camera;
-
-		Scene();
-
-		std::string filename;
-		std::vector<BaseEntity*> entities;
-
-		void clear();
-		void addEntity(BaseEntity* entity);
-
-		bool load(const char* filename);
-		BaseEntity* createEntity(std::string type);
-	};
-
-};
-
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "framework.h"
+#include "fbo.h"
+#include "shadowatlas.h"
+#include "camera.h"
+#include <string>
+
+//forward declaration
+class cJSON;
+
+//our namespace
+namespace GTR {
+
+	enum eEntityType {
+		NONE = 0,
+		PREFAB = 1,
+		LIGHT = 2,
+		CAMERA = 3,
+		REFLECTION_PROBE = 4,
+		DECAL = 5
+	};
+
+	enum eLightType {
+		POINT = 0,
+		SPOT = 1,
+		DIRECTIONAL = 2
+	};
+
+	class Scene;
+	class Prefab;
+
+	//represents one element of the scene (could be lights, prefabs, cameras, etc)
+	class BaseEntity
+	{
+	public:
+		Scene* scene;
+		std::string name;
+		eEntityType entity_type;
+		Matrix44 model;
+		bool visible;
+
+		//change tracking, increased every time the model, the visibility or the content changes
+		unsigned int version;
+
+		BaseEntity() { entity_type = NONE; visible = true; version = 0; last_visible = true; }
+		virtual ~BaseEntity() {}
+		virtual void renderInMenu();
+		virtual void configure(GTR::Scene* scene, cJSON* json) {}
+
+		void markChanged() { version++; }
+
+		//compares with the state of the last call and increases the version if something changed
+		virtual void updateVersion();
+
+	protected:
+		Matrix44 last_model;
+		bool last_visible;
+	};
+
+	//represents one prefab in the scene
+	class PrefabEntity : public GTR::BaseEntity
+	{
+	public:
+		std::string filename;
+		Prefab* prefab;
+
+		PrefabEntity();
+		virtual void renderInMenu();
+		virtual void configure(GTR::Scene* scene, cJSON* json);
+		virtual void updateVersion();
+
+	protected:
+		Prefab* last_prefab;
+		int last_prefab_version;
+	};
+
+	class LightEntity : public GTR::BaseEntity
+	{
+	public:
+		Vector3 color;
+		Vector3 target;
+		float intensity;
+		eLightType light_type;
+		float max_distance;
+		float cone_angle;
+		float spot_exponent;
+		float area_size;
+
+		Camera camera;
+		FBO* fbo; //the shadow atlas while the light has a tile in it
+		sShadowTile shadow_tile;
+		float shadow_bias;
+		bool cast_shadows;
+		int block_index; //position in its page of the light uniform block of this frame
+		int block_page;	//page of the light block, see Renderer::useLightPage
+
+		LightEntity();
+
+		virtual void configure(GTR::Scene* scene, cJSON* json);
+		virtual void renderInMenu();
+		void setLightUniforms(Shader* shader, bool useshadowmap);
+		//sphere that contains all the lit volume (the cone of the spots), not valid for directional lights
+		void getBoundingSphere(Vector3& center, float& radius);
+
+	};
+
+	class DecalEntity : public GTR::BaseEntity {
+	public:
+		Texture* albedo;
+
+		DecalEntity();
+		virtual void configure(GTR::Scene* scene, cJSON* json);
+	};
+
+
+	//contains all entities of the scene
+	class Scene
+	{
+	public:
+		static Scene* instance;
+
+		Texture* enviroment = NULL;
+
+		Vector3 background_color;
+		Vector3 ambient_light;
+		std::vector<LightEntity*> lights;
+		Camera main_camera;
+
+		Scene();
+
+		std::string filename;
+		std::vector<BaseEntity*> entities;
+
+		void clear();
+		void addEntity(BaseEntity* entity);
+
+		bool load(const char* filename);
+		BaseEntity* createEntity(std::string type);
+
+		//checks which entities changed since the last call, once per frame
+		void updateVersions();
+	};
+
+};
+
 #endif
\ No newline at end of file
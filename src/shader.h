@@ -8,7 +8,9 @@
 #include "includes.h"
 #include <string>
 #include <map>
+#include <vector>
 #include "framework.h"
+#include "stringid.h"
 #include <cassert>
 
 #ifdef _DEBUG
@@ -20,6 +22,31 @@
 
 class Texture;
 
+//index in Shader::s_slots, it stays valid when the shader is compiled again or loaded later
+typedef int ShaderHandle;
+
+//binding points of the uniform blocks declared in the atlas, every program links its blocks to them after compiling
+enum eUniformBlockBinding {
+	FRAME_BLOCK_BINDING = 0,	//FrameBlock: camera, time and ambient of the current pass
+	LIGHT_BLOCK_BINDING = 1,	//LightBlock: all the lights of the scene
+	MATERIAL_BLOCK_BINDING = 2,	//MaterialBlock: page of materials
+	CLUSTER_BLOCK_BINDING = 3	//ClusterBlock: lights of every cluster of the view
+};
+
+//every program gets the same location for the vertex attributes, so one vertex array object works with all of them
+enum eVertexAttribLocation {
+	ATTRIB_VERTEX = 0,			//a_vertex
+	ATTRIB_NORMAL = 1,			//a_normal
+	ATTRIB_COORD = 2,			//a_coord
+	ATTRIB_COLOR = 3,			//a_color
+	ATTRIB_COORD1 = 4,			//a_coord1
+	ATTRIB_BONES = 5,			//a_bones
+	ATTRIB_WEIGHTS = 6,			//a_weights
+	ATTRIB_INSTANCE_MODEL = 7,	//u_model in the instanced programs, a mat4 takes 7 to 10
+	ATTRIB_INSTANCE_INVERSE_MODEL = 11,	//u_iModel of the decals, 11 to 14
+	ATTRIB_INSTANCE_LAYER = 15	//a_layer of the decals
+};
+
 class Shader
 {
 	int last_slot;
@@ -48,59 +75,59 @@ public:
 	static void disableShaders();
 
 	//check
-	virtual bool IsUniform(const char* varname) { return (getUniformLocation(varname) != -1); } //uniform exist
-	virtual bool IsAttribute(const char* varname) { return (getAttribLocation(varname) != -1); } //attribute exist
+	virtual bool IsUniform(StringID varname) { return (getUniformLocation(varname) != -1); } //uniform exist
+	virtual bool IsAttribute(StringID varname) { return (getAttribLocation(varname) != -1); } //attribute exist
 
 	//upload
-	void setUniform(const char* varname, bool input) { assert(current == this); setUniform1(varname, input); }
-	void setUniform(const char* varname, int input) { assert(current == this); setUniform1(varname, input); }
-	void setUniform(const char* varname, float input) { assert(current == this); setUniform1(varname, input); }
-	void setUniform(const char* varname, const Vector2& input) { assert(current == this); setUniform2(varname, input.x, input.y ); }
-	void setUniform(const char* varname, const Vector3& input) { assert(current == this); setUniform3(varname, input.x, input.y, input.z); }
-	void setUniform(const char* varname, const Vector4& input) { assert(current == this); setUniform4(varname, input.x, input.y, input.z, input.w); }
-	void setUniform(const char* varname, const Matrix44& input) { assert(current == this); setMatrix44(varname, input); }
-	void setUniform(const char* varname, std::vector<Matrix44>& m_vector) { assert(current == this && m_vector.size()); setMatrix44Array(varname, &m_vector[0], m_vector.size()); }
+	void setUniform(StringID varname, bool input) { assert(current == this); setUniform1(varname, input); }
+	void setUniform(StringID varname, int input) { assert(current == this); setUniform1(varname, input); }
+	void setUniform(StringID varname, float input) { assert(current == this); setUniform1(varname, input); }
+	void setUniform(StringID varname, const Vector2& input) { assert(current == this); setUniform2(varname, input.x, input.y ); }
+	void setUniform(StringID varname, const Vector3& input) { assert(current == this); setUniform3(varname, input.x, input.y, input.z); }
+	void setUniform(StringID varname, const Vector4& input) { assert(current == this); setUniform4(varname, input.x, input.y, input.z, input.w); }
+	void setUniform(StringID varname, const Matrix44& input) { assert(current == this); setMatrix44(varname, input); }
+	void setUniform(StringID varname, std::vector<Matrix44>& m_vector) { assert(current == this && m_vector.size()); setMatrix44Array(varname, &m_vector[0], m_vector.size()); }
 	
 	//for textures you must specify an slot (a number from 0 to 16) where this texture is stored in the shader
-	void setUniform(const char* varname, Texture* texture, int slot) { assert(current == this); setTexture(varname, texture, slot); }
+	void setUniform(StringID varname, Texture* texture, int slot) { assert(current == this); setTexture(varname, texture, slot); }
 
 
-	virtual void setInt(const char* varname, const int& input) { setUniform1(varname, input); }
-	virtual void setFloat(const char* varname, const float& input) { setUniform1(varname, input); }
-	virtual void setVector3(const char* varname, const Vector3& input) { setUniform3(varname, input.x, input.y, input.z); }
-	virtual void setMatrix44(const char* varname, const float* m);
-	virtual void setMatrix44(const char* varname, const Matrix44 &m);
-	virtual void setMatrix44Array(const char* varname, Matrix44* m_array, int num);
+	virtual void setInt(StringID varname, const int& input) { setUniform1(varname, input); }
+	virtual void setFloat(StringID varname, const float& input) { setUniform1(varname, input); }
+	virtual void setVector3(StringID varname, const Vector3& input) { setUniform3(varname, input.x, input.y, input.z); }
+	virtual void setMatrix44(StringID varname, const float* m);
+	virtual void setMatrix44(StringID varname, const Matrix44 &m);
+	virtual void setMatrix44Array(StringID varname, Matrix44* m_array, int num);
 
-	virtual void setUniform1Array(const char* varname, const float* input, const int count) ;
-	virtual void setUniform2Array(const char* varname, const float* input, const int count) ;
-	virtual void setUniform3Array(const char* varname, const float* input, const int count) ;
-	virtual void setUniform4Array(const char* varname, const float* input, const int count) ;
+	virtual void setUniform1Array(StringID varname, const float* input, const int count) ;
+	virtual void setUniform2Array(StringID varname, const float* input, const int count) ;
+	virtual void setUniform3Array(StringID varname, const float* input, const int count) ;
+	virtual void setUniform4Array(StringID varname, const float* input, const int count) ;
 
-	virtual void setUniform1Array(const char* varname, const int* input, const int count) ;
-	virtual void setUniform2Array(const char* varname, const int* input, const int count) ;
-	virtual void setUniform3Array(const char* varname, const int* input, const int count) ;
-	virtual void setUniform4Array(const char* varname, const int* input, const int count) ;
+	virtual void setUniform1Array(StringID varname, const int* input, const int count) ;
+	virtual void setUniform2Array(StringID varname, const int* input, const int count) ;
+	virtual void setUniform3Array(StringID varname, const int* input, const int count) ;
+	virtual void setUniform4Array(StringID varname, const int* input, const int count) ;
 
-	virtual void setUniform1(const char* varname, const bool input1);
+	virtual void setUniform1(StringID varname, const bool input1);
 
-	virtual void setUniform1(const char* varname, const int input1) ;
-	virtual void setUniform2(const char* varname, const int input1, const int input2) ;
-	virtual void setUniform3(const char* varname, const int input1, const int input2, const int input3) ;
-	virtual void setUniform3(const char* varname, const Vector3& input) { setUniform3(varname, input.x, input.y, input.z); }
-	virtual void setUniform4(const char* varname, const int input1, const int input2, const int input3, const int input4) ;
+	virtual void setUniform1(StringID varname, const int input1) ;
+	virtual void setUniform2(StringID varname, const int input1, const int input2) ;
+	virtual void setUniform3(StringID varname, const int input1, const int input2, const int input3) ;
+	virtual void setUniform3(StringID varname, const Vector3& input) { setUniform3(varname, input.x, input.y, input.z); }
+	virtual void setUniform4(StringID varname, const int input1, const int input2, const int input3, const int input4) ;
 
-	virtual void setUniform1(const char* varname, const float input) ;
-	virtual void setUniform2(const char* varname, const float input1, const float input2) ;
-	virtual void setUniform3(const char* varname, const float input1, const float input2, const float input3) ;
-	virtual void setUniform4(const char* varname, const Vector4& input) { setUniform4(varname, input.x, input.y, input.z, input.w); }
-	virtual void setUniform4(const char* varname, const float input1, const float input2, const float input3, const float input4) ;
+	virtual void setUniform1(StringID varname, const float input) ;
+	virtual void setUniform2(StringID varname, const float input1, const float input2) ;
+	virtual void setUniform3(StringID varname, const float input1, const float input2, const float input3) ;
+	virtual void setUniform4(StringID varname, const Vector4& input) { setUniform4(varname, input.x, input.y, input.z, input.w); }
+	virtual void setUniform4(StringID varname, const float input1, const float input2, const float input3, const float input4) ;
 
-	//virtual void setTexture(const char* varname, const unsigned int tex) ;
-	virtual void setTexture(const char* varname, Texture* texture, int slot);
+	//virtual void setTexture(StringID varname, const unsigned int tex) ;
+	virtual void setTexture(StringID varname, Texture* texture, int slot);
 
-	virtual int getAttribLocation(const char* varname);
-	virtual int getUniformLocation(const char* varname);
+	virtual int getAttribLocation(StringID varname);
+	virtual int getUniformLocation(StringID varname);
 
 	std::string getInfoLog() const;
 	bool hasInfoLog() const;
@@ -112,6 +139,13 @@ public:
 	static void ReloadAll();
 	static std::map<std::string,Shader*> s_Shaders;
 
+	//handle based access for the code that picks shaders every draw, no strings involved after getHandle
+	static ShaderHandle getHandle(StringID name); //the slot is reserved even if the shader does not exist yet
+	static Shader* fromHandle(ShaderHandle handle) { return s_slots[handle]; }
+	static std::vector<Shader*> s_slots;
+	static StringIDTable s_slot_ids; //hash of the name -> slot
+	static void registerShader(const std::string& name, Shader* shader); //adds it to s_Shaders and its slot
+
 	//this is a way to load a single file that contains all the shaders 
 	//to know more about the file format, it is based in this https://github.com/jagenjo/rendeer.js/tree/master/guides#the-shaders but with tiny differences
 	static bool LoadAtlas(const char* filename);
@@ -135,6 +169,8 @@ protected:
 	void saveProgramInfoLog(GLuint obj);
 
 	bool validate();
+	void bindUniformBlocks();
+	void bindAttribLocations();
 
 	GLuint vs;
 	GLuint fs;
@@ -142,20 +178,17 @@ protected:
 	std::string log;
 
 //this is a hack to speed up shader usage (save info locally)
-private: 
+public:
+	GLint getLocation( StringID varname, StringIDTable* table );
+	StringIDTable locations;	//hash of the uniform name -> location, -1 if missing
+	StringIDTable attrib_locations;
 
-	struct ltstr
-	{
-		bool operator()(const char* s1, const char* s2) const
-		{
-			return strcmp(s1, s2) < 0;
-		}
-	};	
-	typedef std::map<const char*, int, ltstr> loctable;
+	//last value uploaded to every uniform location of this program
+	static const int MAX_CACHED_UNIFORMS = 1024;
+	std::vector< std::vector<char> > uniform_values;
 
-public:
-	GLint getLocation( const char* varname, loctable* table );
-	loctable locations;	
+	//true if the uniform already has this value, otherwise stores it and returns false so it is uploaded
+	bool isUniformCached(GLint loc, const void* data, int size);
 };
 
 #endif
\ No newline at end of file
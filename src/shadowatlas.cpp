@@ -0,0 +1,117 @@
+#include "shadowatlas.h"
+
+#include <algorithm>
+#include <cassert>
+
+ShadowAtlas::ShadowAtlas()
+{
+	size = 0;
+}
+
+void ShadowAtlas::create(int size)
+{
+	this->size = size;
+	fbo.setDepthOnly(size, size);
+
+	free_tiles.clear();
+	sShadowTile all;
+	all.size = size;
+	free_tiles.push_back(all);
+}
+
+int ShadowAtlas::findFree(int x, int y, int tile_size) const
+{
+	for (int i = 0; i < free_tiles.size(); ++i)
+		if (free_tiles[i].x == x && free_tiles[i].y == y && free_tiles[i].size == tile_size)
+			return i;
+	return -1;
+}
+
+bool ShadowAtlas::allocate(int tile_size, sShadowTile& tile)
+{
+	assert(tile_size >= MIN_TILE_SIZE && tile_size <= size);
+
+	//the smallest free tile that is big enough, so the big ones stay for the lights that need them
+	int best = -1;
+	for (int i = 0; i < free_tiles.size(); ++i)
+		if (free_tiles[i].size >= tile_size && (best == -1 || free_tiles[i].size < free_tiles[best].size))
+			best = i;
+	if (best == -1)
+		return false;
+
+	sShadowTile block = free_tiles[best];
+	free_tiles.erase(free_tiles.begin() + best);
+
+	//keep the first quadrant and free the other three until it has the size
+	while (block.size > tile_size)
+	{
+		block.size /= 2;
+		for (int i = 1; i < 4; ++i)
+		{
+			sShadowTile quadrant = block;
+			quadrant.x += (i & 1) * block.size;
+			quadrant.y += (i >> 1) * block.size;
+			free_tiles.push_back(quadrant);
+		}
+	}
+
+	tile = block;
+	return true;
+}
+
+void ShadowAtlas::release(sShadowTile& tile)
+{
+	if (!tile.size)
+		return;
+
+	sShadowTile block = tile;
+	tile = sShadowTile();
+
+	//merge with the other three quadrants while all of them are free
+	while (block.size < size)
+	{
+		int parent_size = block.size * 2;
+		int px = block.x - block.x % parent_size;
+		int py = block.y - block.y % parent_size;
+
+		int siblings[3];
+		int num_siblings = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			int qx = px + (i & 1) * block.size;
+			int qy = py + (i >> 1) * block.size;
+			if (qx == block.x && qy == block.y)
+				continue;
+			int index = findFree(qx, qy, block.size);
+			if (index == -1)
+				break;
+			siblings[num_siblings++] = index;
+		}
+		if (num_siblings < 3)
+			break;
+
+		//erase from the highest index so the others stay valid
+		std::sort(siblings, siblings + 3);
+		for (int i = 2; i >= 0; --i)
+			free_tiles.erase(free_tiles.begin() + siblings[i]);
+
+		block.x = px;
+		block.y = py;
+		block.size = parent_size;
+	}
+
+	free_tiles.push_back(block);
+}
+
+int ShadowAtlas::getFreeArea() const
+{
+	int area = 0;
+	for (int i = 0; i < free_tiles.size(); ++i)
+		area += free_tiles[i].size * free_tiles[i].size;
+	return area;
+}
+
+Vector4 ShadowAtlas::getRect(const sShadowTile& tile) const
+{
+	return Vector4(tile.x / (float)size, tile.y / (float)size, tile.size / (float)size, tile.size / (float)size);
+}
@@ -0,0 +1,48 @@
+#ifndef SHADOWATLAS_H
+#define SHADOWATLAS_H
+
+#include "includes.h"
+#include "framework.h"
+#include "fbo.h"
+#include <vector>
+
+//square region of the atlas in pixels, size 0 means no tile
+struct sShadowTile {
+	int x;
+	int y;
+	int size;
+
+	sShadowTile() { x = y = size = 0; }
+};
+
+//one big depth texture shared by the shadowmaps of all the lights
+//the tiles are power of two squares handed out like a quadtree (buddy allocator),
+//so a light keeps its tile between frames until it needs another size
+class ShadowAtlas {
+public:
+	static const int MIN_TILE_SIZE = 128;
+
+	FBO fbo;
+	int size;
+
+	ShadowAtlas();
+
+	void create(int size);
+
+	//size must be a power of two between MIN_TILE_SIZE and the atlas size, returns false if there is no room
+	bool allocate(int tile_size, sShadowTile& tile);
+	void release(sShadowTile& tile);
+
+	//pixels not used by any tile
+	int getFreeArea() const;
+
+	//offset and size of the tile in uv space
+	Vector4 getRect(const sShadowTile& tile) const;
+
+private:
+	std::vector<sShadowTile> free_tiles;
+
+	int findFree(int x, int y, int tile_size) const;
+};
+
+#endif
@@ -0,0 +1,291 @@
+#include "simplify.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+//symmetric 4x4 matrix that accumulates the squared distance to a set of planes
+struct sQuadric {
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+	sQuadric() { a2 = ab = ac = ad = b2 = bc = bd = c2 = cd = d2 = 0.0; }
+
+	void addPlane(double a, double b, double c, double d, double weight)
+	{
+		a2 += a * a * weight; ab += a * b * weight; ac += a * c * weight; ad += a * d * weight;
+		b2 += b * b * weight; bc += b * c * weight; bd += b * d * weight;
+		c2 += c * c * weight; cd += c * d * weight;
+		d2 += d * d * weight;
+	}
+
+	void add(const sQuadric& q)
+	{
+		a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+		b2 += q.b2; bc += q.bc; bd += q.bd;
+		c2 += q.c2; cd += q.cd;
+		d2 += q.d2;
+	}
+
+	double evaluate(const Vector3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double r = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+			+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+			+ c2 * z * z + 2 * cd * z
+			+ d2;
+		return r > 0 ? r : 0;
+	}
+};
+
+struct sCollapse {
+	int from;
+	int to;
+	double cost;
+	bool operator < (const sCollapse& c) const { return cost < c.cost; }
+};
+
+//welded triangle, w are the welded positions and v the vertices used to draw it
+struct sSimplifyTriangle {
+	int w[3];
+	unsigned int v[3];
+};
+
+static Vector3 triangleNormal(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	return (b - a).cross(c - a);
+}
+
+float simplifyMesh(const Vector3* positions, int stride, int num_vertices, const unsigned int* indices, int num_indices, int target_triangles, std::vector<unsigned int>& output)
+{
+	const char* data = (const char*)positions;
+	#define POSITION(i) (*(const Vector3*)(data + (size_t)(i) * stride))
+
+	//weld the vertices with the same position so the seams (and not indexed meshes) keep their topology
+	std::vector<int> weld(num_vertices);
+	std::vector<Vector3> welded_pos;
+	std::vector<unsigned int> representative; //vertex used when a corner is moved to a welded position
+	{
+		std::vector<int> order(num_vertices);
+		for (int i = 0; i < num_vertices; ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [data, stride](int a, int b) {
+			const Vector3& pa = POSITION(a);
+			const Vector3& pb = POSITION(b);
+			if (pa.x != pb.x) return pa.x < pb.x;
+			if (pa.y != pb.y) return pa.y < pb.y;
+			return pa.z < pb.z;
+		});
+		for (int i = 0; i < num_vertices; ++i)
+		{
+			int index = order[i];
+			const Vector3& p = POSITION(index);
+			if (i && memcmp(&p, &POSITION(order[i - 1]), sizeof(Vector3)) == 0)
+			{
+				weld[index] = weld[order[i - 1]];
+				continue;
+			}
+			weld[index] = welded_pos.size();
+			welded_pos.push_back(p);
+			representative.push_back(index);
+		}
+	}
+	int num_welded = welded_pos.size();
+
+	std::vector<sSimplifyTriangle> triangles;
+	int num = indices ? num_indices : num_vertices;
+	for (int i = 0; i + 2 < num; i += 3)
+	{
+		sSimplifyTriangle t;
+		for (int j = 0; j < 3; ++j)
+		{
+			t.v[j] = indices ? indices[i + j] : i + j;
+			t.w[j] = weld[t.v[j]];
+		}
+		if (t.w[0] != t.w[1] && t.w[1] != t.w[2] && t.w[0] != t.w[2])
+			triangles.push_back(t);
+	}
+
+	//plane of every triangle
+	std::vector<sQuadric> quadrics(num_welded);
+	for (int i = 0; i < triangles.size(); ++i)
+	{
+		const sSimplifyTriangle& t = triangles[i];
+		Vector3 n = triangleNormal(welded_pos[t.w[0]], welded_pos[t.w[1]], welded_pos[t.w[2]]);
+		if (n.length() < 1e-12f)
+			continue;
+		n.normalize();
+		double d = -n.dot(welded_pos[t.w[0]]);
+		for (int j = 0; j < 3; ++j)
+			quadrics[t.w[j]].addPlane(n.x, n.y, n.z, d, 1.0);
+	}
+
+	//the open borders get a perpendicular plane so they do not shrink
+	{
+		std::vector<std::pair<int, int> > edges;
+		std::vector<int> edge_triangle;
+		for (int i = 0; i < triangles.size(); ++i)
+			for (int j = 0; j < 3; ++j)
+			{
+				int a = triangles[i].w[j], b = triangles[i].w[(j + 1) % 3];
+				edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+			}
+		std::vector<std::pair<int, int> > sorted_edges = edges;
+		std::sort(sorted_edges.begin(), sorted_edges.end());
+		for (int i = 0; i < edges.size(); ++i)
+		{
+			std::pair<int, int> range = std::make_pair(
+				(int)(std::lower_bound(sorted_edges.begin(), sorted_edges.end(), edges[i]) - sorted_edges.begin()),
+				(int)(std::upper_bound(sorted_edges.begin(), sorted_edges.end(), edges[i]) - sorted_edges.begin()));
+			if (range.second - range.first != 1)
+				continue;
+
+			const sSimplifyTriangle& t = triangles[i / 3];
+			Vector3 a = welded_pos[edges[i].first];
+			Vector3 b = welded_pos[edges[i].second];
+			Vector3 n = triangleNormal(welded_pos[t.w[0]], welded_pos[t.w[1]], welded_pos[t.w[2]]);
+			Vector3 border = (b - a).cross(n);
+			if (border.length() < 1e-12f)
+				continue;
+			border.normalize();
+			double d = -border.dot(a);
+			quadrics[edges[i].first].addPlane(border.x, border.y, border.z, d, 10.0);
+			quadrics[edges[i].second].addPlane(border.x, border.y, border.z, d, 10.0);
+		}
+	}
+
+	double max_cost = 0;
+	std::vector<std::pair<int, int> > edges;
+	std::vector<sCollapse> collapses;
+	std::vector<int> remap(num_welded);
+	std::vector<char> locked(num_welded);
+	std::vector<int> adjacency_start(num_welded + 1);
+	std::vector<int> adjacency;
+
+	//every pass collapses the cheapest edges that do not touch each other
+	while (triangles.size() > target_triangles)
+	{
+		//every edge once
+		edges.clear();
+		for (int i = 0; i < triangles.size(); ++i)
+			for (int j = 0; j < 3; ++j)
+			{
+				int a = triangles[i].w[j], b = triangles[i].w[(j + 1) % 3];
+				edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+			}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		collapses.clear();
+		for (int i = 0; i < edges.size(); ++i)
+		{
+			int a = edges[i].first, b = edges[i].second;
+			sQuadric q = quadrics[a];
+			q.add(quadrics[b]);
+			sCollapse c;
+			double cost_ab = q.evaluate(welded_pos[b]);
+			double cost_ba = q.evaluate(welded_pos[a]);
+			c.from = cost_ab < cost_ba ? a : b;
+			c.to = cost_ab < cost_ba ? b : a;
+			c.cost = std::min(cost_ab, cost_ba);
+			collapses.push_back(c);
+		}
+		std::sort(collapses.begin(), collapses.end());
+
+		//triangles around every welded vertex
+		std::fill(adjacency_start.begin(), adjacency_start.end(), 0);
+		for (int i = 0; i < triangles.size(); ++i)
+			for (int j = 0; j < 3; ++j)
+				adjacency_start[triangles[i].w[j] + 1]++;
+		for (int i = 0; i < num_welded; ++i)
+			adjacency_start[i + 1] += adjacency_start[i];
+		adjacency.resize(adjacency_start[num_welded]);
+		{
+			std::vector<int> fill = adjacency_start;
+			for (int i = 0; i < triangles.size(); ++i)
+				for (int j = 0; j < 3; ++j)
+					adjacency[fill[triangles[i].w[j]]++] = i;
+		}
+
+		for (int i = 0; i < num_welded; ++i)
+			remap[i] = i;
+		std::fill(locked.begin(), locked.end(), 0);
+
+		int to_remove = triangles.size() - target_triangles;
+		int removed = 0;
+		int num_collapsed = 0;
+		for (int i = 0; i < collapses.size() && removed < to_remove; ++i)
+		{
+			const sCollapse& c = collapses[i];
+			if (locked[c.from] || locked[c.to])
+				continue;
+
+			//reject the collapse if any triangle around would flip
+			bool flips = false;
+			int degenerated = 0;
+			for (int k = adjacency_start[c.from]; k < adjacency_start[c.from + 1]; ++k)
+			{
+				const sSimplifyTriangle& t = triangles[adjacency[k]];
+				if (t.w[0] == c.to || t.w[1] == c.to || t.w[2] == c.to)
+				{
+					degenerated++;
+					continue;
+				}
+				Vector3 p[3], moved[3];
+				for (int j = 0; j < 3; ++j)
+				{
+					p[j] = welded_pos[t.w[j]];
+					moved[j] = t.w[j] == c.from ? welded_pos[c.to] : p[j];
+				}
+				Vector3 before = triangleNormal(p[0], p[1], p[2]);
+				Vector3 after = triangleNormal(moved[0], moved[1], moved[2]);
+				if (before.dot(after) <= 0.25f * before.length() * after.length())
+				{
+					flips = true;
+					break;
+				}
+			}
+			if (flips)
+				continue;
+
+			remap[c.from] = c.to;
+			quadrics[c.to].add(quadrics[c.from]);
+			max_cost = std::max(max_cost, c.cost);
+			removed += degenerated;
+			num_collapsed++;
+
+			//the triangles around changed, nothing near can collapse in this pass
+			for (int k = adjacency_start[c.from]; k < adjacency_start[c.from + 1]; ++k)
+			{
+				const sSimplifyTriangle& t = triangles[adjacency[k]];
+				locked[t.w[0]] = locked[t.w[1]] = locked[t.w[2]] = 1;
+			}
+		}
+
+		if (!num_collapsed)
+			break;
+
+		//apply the collapses and remove the degenerated triangles
+		int num_triangles = 0;
+		for (int i = 0; i < triangles.size(); ++i)
+		{
+			sSimplifyTriangle t = triangles[i];
+			for (int j = 0; j < 3; ++j)
+				if (remap[t.w[j]] != t.w[j])
+				{
+					t.w[j] = remap[t.w[j]];
+					t.v[j] = representative[t.w[j]];
+				}
+			if (t.w[0] != t.w[1] && t.w[1] != t.w[2] && t.w[0] != t.w[2])
+				triangles[num_triangles++] = t;
+		}
+		triangles.resize(num_triangles);
+	}
+
+	output.resize(triangles.size() * 3);
+	for (int i = 0; i < triangles.size(); ++i)
+		for (int j = 0; j < 3; ++j)
+			output[i * 3 + j] = triangles[i].v[j];
+
+	#undef POSITION
+	return (float)sqrt(max_cost);
+}
@@ -0,0 +1,14 @@
+/*  mesh simplification using quadric error metrics (Garland & Heckbert 97)
+	Vertices are only collapsed into other existing vertices, so the result is a new index buffer that
+	can be drawn with the same vertex buffer. Used to build the LOD chain of the meshes.
+*/
+
+#pragma once
+
+#include "framework.h"
+#include <vector>
+
+//simplifies a triangle list until it has target_triangles (or it can not remove more without flipping triangles)
+//positions are read every stride bytes, indices can be NULL for meshes without indices
+//returns the max error introduced, in the same units as the positions
+float simplifyMesh(const Vector3* positions, int stride, int num_vertices, const unsigned int* indices, int num_indices, int target_triangles, std::vector<unsigned int>& output);
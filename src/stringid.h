@@ -0,0 +1,149 @@
+/*  hashed strings
+	Names used as keys (shaders, uniforms, resources) are turned into a 32 bits FNV-1a hash,
+	with literals the hash is computed by the compiler so lookups never touch the characters.
+*/
+
+#ifndef STRINGID_H
+#define STRINGID_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+//single expression so it is a valid constexpr in C++11 (VS2015)
+constexpr uint32_t hashString(const char* str, uint32_t hash = FNV_OFFSET_BASIS)
+{
+	return *str ? hashString(str + 1, (hash ^ (uint32_t)(unsigned char)*str) * FNV_PRIME) : hash;
+}
+
+//same hash without recursion, for the strings built at runtime
+inline uint32_t hashStringRuntime(const char* str, size_t length)
+{
+	uint32_t hash = FNV_OFFSET_BASIS;
+	for (size_t i = 0; i < length; ++i)
+		hash = (hash ^ (uint32_t)(unsigned char)str[i]) * FNV_PRIME;
+	return hash;
+}
+
+//hash of a name and the name itself, only needed the first time (to ask OpenGL for a location, to load a file...)
+//the string is not copied, it must live as long as the id is used
+struct StringID {
+	uint32_t hash;
+	const char* str;
+
+	StringID(const char* s) : hash(hashStringRuntime(s, strlen(s))), str(s) {}
+	constexpr StringID(uint32_t h, const char* s) : hash(h), str(s) {}
+};
+
+//id of a literal with the hash computed at compile time: shader->setUniform(SID("u_model"), model)
+#define SID(s) StringID(std::integral_constant<uint32_t, hashString(s)>::value, s)
+
+//to use std::string keys in unordered maps with the same hash
+struct StringIDHash {
+	size_t operator()(const std::string& str) const { return hashStringRuntime(str.c_str(), str.size()); }
+};
+
+//flat open addressing table from a hash to an int, for small tables queried constantly (uniform locations)
+//collisions of the 32 bits hash are not handled, only the debug builds keep the names to detect them
+class StringIDTable {
+public:
+	StringIDTable() { count = 0; }
+
+	//returns false if the hash is not in the table
+	bool find(const StringID& id, int& value) const
+	{
+		if (!slots.size())
+			return false;
+		uint32_t hash = id.hash ? id.hash : 1; //0 marks the empty slots
+		size_t mask = slots.size() - 1;
+		for (size_t i = hash & mask; ; i = (i + 1) & mask)
+		{
+			const sSlot& slot = slots[i];
+			if (slot.hash == hash)
+			{
+				checkName(i, id.str);
+				value = slot.value;
+				return true;
+			}
+			if (!slot.hash)
+				return false;
+		}
+	}
+
+	void insert(const StringID& id, int value)
+	{
+		uint32_t hash = id.hash ? id.hash : 1;
+		//keep it at most half full so the probes stay short
+		if ((count + 1) * 2 > (int)slots.size())
+			grow();
+		size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+		while (slots[i].hash && slots[i].hash != hash)
+			i = (i + 1) & mask;
+		if (!slots[i].hash)
+		{
+			count++;
+#ifndef NDEBUG
+			names[i] = id.str ? id.str : "";
+#endif
+		}
+		else
+			checkName(i, id.str);
+		slots[i].hash = hash;
+		slots[i].value = value;
+	}
+
+	void clear()
+	{
+		slots.clear();
+		count = 0;
+#ifndef NDEBUG
+		names.clear();
+#endif
+	}
+	int size() const { return count; }
+
+private:
+	struct sSlot {
+		uint32_t hash;
+		int value;
+	};
+	std::vector<sSlot> slots; //size is always a power of two
+	int count;
+
+#ifndef NDEBUG
+	std::vector<std::string> names; //name stored in every slot, to assert that two names never share a hash
+	void checkName(size_t i, const char* str) const { assert((!str || !names[i].size() || names[i] == str) && "two names with the same hash"); }
+#else
+	void checkName(size_t i, const char* str) const {}
+#endif
+
+	void grow()
+	{
+		std::vector<sSlot> old;
+		old.swap(slots);
+		slots.resize(old.size() ? old.size() * 2 : 32);
+		memset(&slots[0], 0, slots.size() * sizeof(sSlot));
+		count = 0;
+#ifndef NDEBUG
+		std::vector<std::string> old_names;
+		old_names.swap(names);
+		names.resize(slots.size());
+		for (size_t i = 0; i < old.size(); ++i)
+			if (old[i].hash)
+				insert(StringID(old[i].hash, old_names[i].c_str()), old[i].value);
+#else
+		for (size_t i = 0; i < old.size(); ++i)
+			if (old[i].hash)
+				insert(StringID(old[i].hash, NULL), old[i].value);
+#endif
+	}
+};
+
+#endif
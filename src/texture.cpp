@@ -8,6 +8,7 @@
 
 #include "mesh.h"
 #include "shader.h"
+#include "glstate.h"
 #include "extra/picopng.h"
 #include "extra/jpgd.h"
 #include <cassert>
@@ -57,10 +58,11 @@ Vector4 Image::getPixelInterpolatedHigh(float x, float y, bool repeat) {
 };
 
 
-std::map<std::string, Texture*> Texture::sTexturesLoaded;
+std::unordered_map<std::string, Texture*, StringIDHash> Texture::sTexturesLoaded;
 int Texture::default_mag_filter = GL_LINEAR;
 int Texture::default_min_filter = GL_LINEAR_MIPMAP_LINEAR;
 FBO* Texture::global_fbo = NULL;
+bool Texture::use_full_precision = false;
 
 Texture::Texture()
 {
@@ -93,11 +95,14 @@ Texture::~Texture()
 
 void Texture::clear()
 {
-	glBindTexture(this->texture_type, 0);
+	GLState::bindTexture(this->texture_type, 0);
 
 	//external textures are handled by an outside system (like Android OS)
 	if( texture_type != GL_TEXTURE_EXTERNAL_OES)
+	{
+		GLState::forgetTexture(texture_id);
 		glDeleteTextures(1, &texture_id);
+	}
 
 	stdlog("Destroy texture: " + filename );
 	texture_id = 0;
@@ -209,7 +214,7 @@ void Texture::createCubemap(unsigned int width, unsigned int height, Uint8** dat
 	if (texture_id == 0)
 		glGenTextures(1, &texture_id); //we need to create an unique ID for the texture
 
-	glBindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
+	GLState::bindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
 	uploadCubemap(format, type, mipmaps, data, internal_format);
 }
 
@@ -289,14 +294,14 @@ void Texture::loadFromImage(Image* image, bool mipmaps, bool wrap, unsigned int
 	// We have to synchronously upload for now because Image class is not ref-counted
 	create(image->width, image->height, (image->num_channels == 3 ? GL_RGB : GL_RGBA), type,  mipmaps, image->data, 0);
 
-	glBindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
+	GLState::bindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
 	glTexParameteri(this->texture_type, GL_TEXTURE_WRAP_S, (this->mipmaps && wrap) ? GL_REPEAT : GL_CLAMP_TO_EDGE);
 	glTexParameteri(this->texture_type, GL_TEXTURE_WRAP_T, (this->mipmaps && wrap) ? GL_REPEAT : GL_CLAMP_TO_EDGE);
 	//glTexParameteri(this->texture_type, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	//glTexParameteri(this->texture_type, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	//if (mipmaps)
 	//	generateMipmaps();
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::upload(Image* img)
@@ -317,7 +322,7 @@ void Texture::upload( unsigned int format, unsigned int type, bool mipmaps, Uint
 	assert(texture_id && "Must create texture before uploading data.");
 	assert(texture_type == GL_TEXTURE_2D && "Texture type does not match.");
 
-	glBindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
+	GLState::bindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
 
 	if (internal_format == 0)
 	{
@@ -338,7 +343,7 @@ void Texture::upload( unsigned int format, unsigned int type, bool mipmaps, Uint
 	if (data && this->mipmaps)
 		generateMipmaps(); //glGenerateMipmapEXT(GL_TEXTURE_2D); 
 
-	glBindTexture(this->texture_type, 0);
+	GLState::bindTexture(this->texture_type, 0);
 	assert(checkGLErrors() && "Error uploading texture");
 }
 
@@ -347,7 +352,7 @@ void Texture::upload3D(unsigned int format, unsigned int type, bool mipmaps, Uin
 	assert(texture_id && "Must create texture before uploading data.");
 	assert(texture_type == GL_TEXTURE_3D && "Texture type does not match.");
 
-	glBindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
+	GLState::bindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
 
 	glTexImage3D(this->texture_type, 0, internal_format == 0 ? format : internal_format, width, height, depth, 0, format, type, data);
 
@@ -360,7 +365,7 @@ void Texture::upload3D(unsigned int format, unsigned int type, bool mipmaps, Uin
 	if (data && this->mipmaps)
 		generateMipmaps(); //glGenerateMipmapEXT(GL_TEXTURE_2D); 
 
-	glBindTexture(this->texture_type, 0);
+	GLState::bindTexture(this->texture_type, 0);
 	assert(checkGLErrors() && "Error uploading texture");
 }
 */
@@ -371,7 +376,7 @@ void Texture::uploadCubemap(unsigned int format, unsigned int t, bool mips, Uint
 	assert(texture_type == GL_TEXTURE_CUBE_MAP && "Texture type does not match.");
 	//assert(glGetError() == GL_NO_ERROR);
 
-	glBindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
+	GLState::bindTexture(this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
 
 	int w = ((int)this->width) >> level;
 	int h = ((int)this->height) >> level;
@@ -411,7 +416,7 @@ void Texture::uploadCubemap(unsigned int format, unsigned int t, bool mips, Uint
 		//	generateMipmaps();
 	}
 
-	glBindTexture(this->texture_type, 0);
+	GLState::bindTexture(this->texture_type, 0);
 	assert(glGetError() == GL_NO_ERROR && "Error creating texture");
 }
 
@@ -471,7 +476,7 @@ void Texture::uploadAsArray(unsigned int texture_size, bool mipmaps)
 	assert(glGetError() == GL_NO_ERROR);
 	if (texture_id == 0)
 		glGenTextures(1, &texture_id); //we need to create an unique ID for the texture
-	glBindTexture( this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
+	GLState::bindTexture( this->texture_type, texture_id);	//we activate this id to tell opengl we are going to use this texture
 	glTexImage3D( this->texture_type, 0, format, width, height, num_textures, 0, dataFormat, type, data);
 	assert(glGetError() == GL_NO_ERROR);
 
@@ -494,13 +499,13 @@ void Texture::uploadAsArray(unsigned int texture_size, bool mipmaps)
 void Texture::bind()
 {
 	//glEnable(this->texture_type); //enable the textures 
-	glBindTexture(this->texture_type, texture_id );	//enable the id of the texture we are going to use
+	GLState::bindTexture(this->texture_type, texture_id );	//enable the id of the texture we are going to use
 }
 
 void Texture::unbind()
 {
 	//glDisable(this->texture_type); //disable the textures 
-	glBindTexture(this->texture_type, 0 );	//disable the id of the texture we are going to use
+	GLState::bindTexture(this->texture_type, 0 );	//disable the id of the texture we are going to use
 }
 
 void Texture::UnbindAll()
@@ -508,9 +513,9 @@ void Texture::UnbindAll()
 	glDisable( GL_TEXTURE_CUBE_MAP );
 	glDisable( GL_TEXTURE_2D );
 	glDisable(GL_TEXTURE_3D);
-	glBindTexture( GL_TEXTURE_2D, 0 );
-	glBindTexture( GL_TEXTURE_CUBE_MAP, 0 );
-	glBindTexture(GL_TEXTURE_3D, 0);
+	GLState::bindTexture( GL_TEXTURE_2D, 0 );
+	GLState::bindTexture( GL_TEXTURE_CUBE_MAP, 0 );
+	GLState::bindTexture(GL_TEXTURE_3D, 0);
 }
 
 void Texture::generateMipmaps()
@@ -519,7 +524,7 @@ void Texture::generateMipmaps()
 		if(!glGenerateMipmapEXT)
 			return;
 
-		glBindTexture(this->texture_type, texture_id );	//enable the id of the texture we are going to use
+		GLState::bindTexture(this->texture_type, texture_id );	//enable the id of the texture we are going to use
 		glTexParameteri(this->texture_type, GL_TEXTURE_MIN_FILTER, Texture::default_min_filter ); //set the mag filter
 		if (this->texture_type == GL_TEXTURE_CUBE_MAP)
 		{
@@ -528,7 +533,7 @@ void Texture::generateMipmaps()
 		}
 		glGenerateMipmapEXT(this->texture_type);
 #else
-	glBindTexture(this->texture_type, texture_id);	//enable the id of the texture we are going to use
+	GLState::bindTexture(this->texture_type, texture_id);	//enable the id of the texture we are going to use
 	glTexParameteri(this->texture_type, GL_TEXTURE_MIN_FILTER, Texture::default_min_filter);
 	glGenerateMipmap(this->texture_type);
     #endif
@@ -544,8 +549,8 @@ void Texture::toViewport(Shader* shader)
 	if(shader->getUniformLocation("u_texture") != -1)
 		shader->setUniform("u_texture", this, 0);
 	assert(glGetError() == GL_NO_ERROR);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_CULL_FACE);
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::disable(GL_CULL_FACE);
 	quad->render(GL_TRIANGLES);
 	assert(glGetError() == GL_NO_ERROR);
 	shader->disable();
@@ -559,6 +564,37 @@ FBO* Texture::getGlobalFBO(Texture* texture)
 	return global_fbo;
 }
 
+unsigned int Texture::getFloatFormat(eFloatPrecision precision, unsigned int format)
+{
+	bool rgb = format == GL_RGB;
+	if (use_full_precision)
+		return precision == FLOAT_HALF_RG ? GL_RG32F : rgb ? GL_RGB32F : GL_RGBA32F;
+
+	switch (precision)
+	{
+		case FLOAT_HALF: return rgb ? GL_RGB16F : GL_RGBA16F;
+		case FLOAT_PACKED_COLOR: return GL_R11F_G11F_B10F;
+		case FLOAT_HALF_RG: return GL_RG16F;
+		case FLOAT_SHARED_EXPONENT: return GL_RGB9_E5;
+		default: return rgb ? GL_RGB32F : GL_RGBA32F;
+	}
+}
+
+int Texture::getBytesPerPixel(unsigned int internal_format)
+{
+	switch (internal_format)
+	{
+		case GL_RGBA32F: return 16;
+		case GL_RGB32F: return 12;
+		case GL_RGBA16F: case GL_RG32F: return 8;
+		case GL_RGB16F: return 6;
+		case GL_RG16F: case GL_R11F_G11F_B10F: case GL_RGB9_E5: case GL_RGBA8: case GL_RGBA: return 4;
+		case GL_RGB8: case GL_RGB: return 3;
+		case GL_RED: case GL_R8: return 1;
+	}
+	return 4;
+}
+
 Texture* Texture::getBlackTexture()
 {
 	static Texture* black = NULL;
@@ -585,8 +621,8 @@ void Texture::copyTo(Texture* destination, Shader* shader)
 	{
 		if (format == GL_DEPTH_COMPONENT) //to clone depth buffer
 		{
-			glEnable(GL_DEPTH_TEST); //we need to use the depth buffer
-			glDepthFunc(GL_ALWAYS); //but ignore the test, every fragment should update the depth
+			GLState::enable(GL_DEPTH_TEST); //we need to use the depth buffer
+			GLState::depthFunc(GL_ALWAYS); //but ignore the test, every fragment should update the depth
 			glColorMask(false, false, false, false); //block drawing to colors
 			if(!shader)
 				shader = Shader::getDefaultShader("screen_depth");
@@ -597,28 +633,28 @@ void Texture::copyTo(Texture* destination, Shader* shader)
 		shader->enable();
 		shader->setUniform("u_texture", this, 0);
 		shader->setUniform("u_color", Vector4(1,1,1,1) );
-		glDisable(GL_CULL_FACE);
+		GLState::disable(GL_CULL_FACE);
 		quad->render(GL_TRIANGLES);
 		glColorMask(true, true, true, true);
-		glDisable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LESS);
+		GLState::disable(GL_DEPTH_TEST);
+		GLState::depthFunc(GL_LESS);
 		return;
 	}
 
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::disable(GL_BLEND);
 	FBO* fbo = getGlobalFBO(destination);
 	fbo->bind();
 	if (!shader && format == GL_DEPTH_COMPONENT)
 	{
 		shader = Shader::getDefaultShader("screen_depth");
-		glDepthFunc(GL_ALWAYS);
-		glEnable(GL_DEPTH_TEST);
+		GLState::depthFunc(GL_ALWAYS);
+		GLState::enable(GL_DEPTH_TEST);
 	}
 	toViewport(shader);
 	fbo->unbind();
-	glDisable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
+	GLState::disable(GL_DEPTH_TEST);
+	GLState::depthFunc(GL_LESS);
 }
 
 void Image::fromScreen(int width, int height)
@@ -7,6 +7,8 @@
 #include "includes.h"
 #include "framework.h"
 #include <map>
+#include <unordered_map>
+#include "stringid.h"
 #include <string>
 #include <cassert>
 
@@ -22,6 +24,15 @@ class Texture;
 #define GL_RGBA16F 0x881A
 #endif
 
+//precision a float render target or HDR texture needs, Texture::getFloatFormat picks the internal format
+enum eFloatPrecision {
+	FLOAT_FULL,				//RGBA32F or RGB32F
+	FLOAT_HALF,				//RGBA16F or RGB16F, signed values and alpha
+	FLOAT_PACKED_COLOR,		//R11G11B10F, positive color without alpha, 4 bytes per pixel
+	FLOAT_HALF_RG,			//RG16F, two signed channels
+	FLOAT_SHARED_EXPONENT	//RGB9E5, positive color that is only sampled, it can not be rendered to
+};
+
 #ifndef GL_TEXTURE_EXTERNAL_OES
 	#define GL_TEXTURE_EXTERNAL_OES 0x8D65
 #endif
@@ -103,11 +114,12 @@ public:
 	static int default_mag_filter;
 	static int default_min_filter;
 	static FBO* global_fbo;
+	static bool use_full_precision;	//ignores the precision asked by the targets, to compare the results
 
 	//a general struct to store all the information about a TGA file
 
 	//textures manager
-	static std::map<std::string, Texture*> sTexturesLoaded;
+	static std::unordered_map<std::string, Texture*, StringIDHash> sTexturesLoaded;
 
 	GLuint texture_id; // GL id to identify the texture in opengl, every texture must have its own id
 	float width;
@@ -177,6 +189,9 @@ public:
 	void copyTo(Texture* destination, Shader* shader = NULL);
 
 	static FBO* getGlobalFBO(Texture* texture);
+	//internal format for a float texture with this precision, format is the GL_RGB or GL_RGBA of the data
+	static unsigned int getFloatFormat(eFloatPrecision precision, unsigned int format = GL_RGBA);
+	static int getBytesPerPixel(unsigned int internal_format);
 	static Texture* getBlackTexture();
 	static Texture* getWhiteTexture();
 };
@@ -0,0 +1,50 @@
+#include "ubo.h"
+#include <cassert>
+
+UBO::UBO()
+{
+	ubo_id = 0;
+	size = 0;
+}
+
+UBO::~UBO()
+{
+	clear();
+}
+
+void UBO::clear()
+{
+	if (ubo_id)
+		glDeleteBuffers(1, &ubo_id);
+	ubo_id = 0;
+	size = 0;
+}
+
+void UBO::create(int size, const void* data)
+{
+	if (!ubo_id)
+		glGenBuffers(1, &ubo_id);
+	this->size = size;
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo_id);
+	glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::update(const void* data, int size, int offset)
+{
+	assert(ubo_id && offset + size <= this->size);
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo_id);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UBO::bind(int binding)
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo_id);
+}
+
+void UBO::bindRange(int binding, int offset, int size)
+{
+	assert(offset + size <= this->size);
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, ubo_id, offset, size);
+}
@@ -0,0 +1,27 @@
+#ifndef UBO_H
+#define UBO_H
+
+#include "includes.h"
+
+//UniformBufferObject
+//block of uniforms stored in the GPU and shared by all the programs that declare it
+//the data must follow the std140 layout of the block in the shader
+
+class UBO {
+public:
+	GLuint ubo_id;
+	int size;
+
+	UBO();
+	~UBO();
+
+	void create(int size, const void* data = NULL);
+	void update(const void* data, int size, int offset = 0);
+
+	void bind(int binding); //the whole buffer
+	void bindRange(int binding, int offset, int size); //offset must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+	void clear();
+};
+
+#endif
@@ -0,0 +1,62 @@
+/*  checks the frustum classification used to accept whole nodes of the hierarchies (SceneBVH, DecalRenderer)
+	Runs without a window, build and run with "make test".
+*/
+
+#include "camera.h"
+#include "culling.h"
+
+#include <cstdio>
+
+//camera.cpp only calls it when the matrices are sent to the fixed pipeline, never here
+bool checkGLErrors() { return true; }
+
+static int num_failed = 0;
+
+#define CHECK(cond) if (!(cond)) { printf("FAILED %s:%d %s\n", __FILE__, __LINE__, #cond); num_failed++; }
+
+int main()
+{
+	//looking down -z from z = 10, the near plane at 9 and the far one at -90
+	Camera camera;
+	camera.setPerspective(60, 1, 1, 100);
+	camera.lookAt(Vector3(0, 0, 10), Vector3(0, 0, 0), Vector3(0, 1, 0));
+
+	//a node completely inside must be accepted without testing its children
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, 0), Vector3(1, 1, 1)) == CLIP_INSIDE);
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, -50), Vector3(10, 10, 10)) == CLIP_INSIDE);
+
+	//crossing one plane only
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, 0), Vector3(100, 1, 1)) == CLIP_OVERLAP);
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, 9), Vector3(1, 1, 1)) == CLIP_OVERLAP);
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, -90), Vector3(1, 1, 1)) == CLIP_OVERLAP);
+
+	//bigger than the frustum, it overlaps all the planes
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, 0), Vector3(1000, 1000, 1000)) == CLIP_OVERLAP);
+
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, 20), Vector3(1, 1, 1)) == CLIP_OUTSIDE);
+	CHECK(camera.testBoxInFrustum(Vector3(0, 0, -200), Vector3(1, 1, 1)) == CLIP_OUTSIDE);
+	CHECK(camera.testBoxInFrustum(Vector3(50, 0, 0), Vector3(1, 1, 1)) == CLIP_OUTSIDE);
+
+	//the batch test used for the leaves agrees with the single test
+	BoxArraySoA boxes;
+	for (int i = 0; i < 37; ++i)
+		boxes.add(Vector3(i * 4.0f - 70.0f, (i % 5) * 3.0f, -i * 3.0f), Vector3(1, 1, 1));
+	std::vector<unsigned char> mask(boxes.size());
+	for (int level = SIMD_SCALAR; level <= getSIMDLevel(); ++level)
+	{
+		testBoxesInFrustum(camera.frustum, boxes, &mask[0], (eSIMDLevel)level);
+		for (int i = 0; i < boxes.size(); ++i)
+		{
+			char clip = camera.testBoxInFrustum(Vector3(boxes.cx[i], boxes.cy[i], boxes.cz[i]), Vector3(boxes.hx[i], boxes.hy[i], boxes.hz[i]));
+			CHECK((mask[i] != 0) == (clip != CLIP_OUTSIDE));
+		}
+	}
+
+	if (num_failed)
+	{
+		printf("culling_test: %d checks failed\n", num_failed);
+		return 1;
+	}
+	printf("culling_test: ok\n");
+	return 0;
+}
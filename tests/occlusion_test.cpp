@@ -0,0 +1,155 @@
+/*  checks and times the software occlusion buffer with hand made occluders
+	It only uses the cpu, no window, SDL or OpenGL. Build and run with "make test".
+*/
+
+#include "occlusion.h"
+#include "jobs.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static int num_failed = 0;
+
+#define CHECK(cond) if (!(cond)) { printf("FAILED %s:%d %s\n", __FILE__, __LINE__, #cond); num_failed++; }
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//camera at z = 10 looking down -z, same convention as Camera (view * projection)
+static Matrix44 getViewProjection()
+{
+	Vector3 eye(0, 0, 10), center(0, 0, 0), up(0, 1, 0);
+	Matrix44 view, projection;
+	view.lookAt(eye, center, up);
+	projection.perspective(60, 2, 1, 100);
+	return view * projection;
+}
+
+//square of side 2 * halfsize in the plane z of the model, two triangles
+static void addQuad(OcclusionBuffer& buffer, const Matrix44& model, float halfsize)
+{
+	const Vector3 vertices[4] = { Vector3(-halfsize, -halfsize, 0), Vector3(halfsize, -halfsize, 0), Vector3(halfsize, halfsize, 0), Vector3(-halfsize, halfsize, 0) };
+	const unsigned int indices[6] = { 0, 1, 2, 0, 2, 3 };
+	buffer.addOccluder(model, vertices, sizeof(Vector3), 4, indices, 6);
+}
+
+static void testClassification(bool use_threads)
+{
+	OcclusionBuffer buffer(256, 128);
+	buffer.clear(getViewProjection());
+
+	//a wall of 10x10 at z = 0
+	Matrix44 model;
+	model.setIdentity();
+	addQuad(buffer, model, 5);
+	buffer.rasterize(use_threads);
+	CHECK(buffer.num_occluders == 1);
+	CHECK(buffer.num_triangles == 2);
+
+	//behind the wall
+	CHECK(buffer.isOccluded(BoundingBox(Vector3(0, 0, -10), Vector3(1, 1, 1))));
+	CHECK(buffer.isOccluded(BoundingBox(Vector3(3, -3, -40), Vector3(2, 2, 2))));
+
+	//in front of the wall, or crossing it
+	CHECK(!buffer.isOccluded(BoundingBox(Vector3(0, 0, 5), Vector3(1, 1, 1))));
+	CHECK(!buffer.isOccluded(BoundingBox(Vector3(0, 0, 0), Vector3(1, 1, 1))));
+
+	//behind but seen past the border of the wall
+	CHECK(!buffer.isOccluded(BoundingBox(Vector3(12, 0, -10), Vector3(1, 1, 1))));
+
+	//around the camera, it crosses the near plane
+	CHECK(!buffer.isOccluded(BoundingBox(Vector3(0, 0, 10), Vector3(2, 2, 2))));
+
+	//nothing drawn
+	buffer.clear(getViewProjection());
+	buffer.rasterize(use_threads);
+	CHECK(!buffer.isOccluded(BoundingBox(Vector3(0, 0, -10), Vector3(1, 1, 1))));
+}
+
+//the bands of the threads must give the same buffer as a single thread
+static void testThreadsMatch()
+{
+	OcclusionBuffer single(256, 128), threaded(256, 128);
+	OcclusionBuffer* buffers[2] = { &single, &threaded };
+	for (int b = 0; b < 2; ++b)
+	{
+		srand(1);
+		buffers[b]->clear(getViewProjection());
+		for (int i = 0; i < 50; ++i)
+		{
+			Matrix44 model;
+			model.setTranslation((rand() % 200 - 100) * 0.2f, (rand() % 100 - 50) * 0.2f, -(rand() % 400) * 0.2f);
+			addQuad(*buffers[b], model, 1.0f + (rand() % 10) * 0.3f);
+		}
+		buffers[b]->rasterize(b == 1);
+	}
+	CHECK(single.depth == threaded.depth);
+	CHECK(single.tile_max == threaded.tile_max);
+}
+
+static void benchmark(int iterations)
+{
+	const int NUM_OCCLUDERS = 500;
+	const int NUM_BOXES = 20000;
+
+	OcclusionBuffer buffer(256, 128);
+	std::vector<Matrix44> models(NUM_OCCLUDERS);
+	srand(2);
+	for (int i = 0; i < NUM_OCCLUDERS; ++i)
+		models[i].setTranslation((rand() % 200 - 100) * 0.3f, (rand() % 100 - 50) * 0.3f, -(rand() % 400) * 0.2f);
+	std::vector<BoundingBox> boxes(NUM_BOXES);
+	for (int i = 0; i < NUM_BOXES; ++i)
+		boxes[i] = BoundingBox(Vector3((rand() % 200 - 100) * 0.3f, (rand() % 100 - 50) * 0.3f, -(rand() % 500) * 0.2f), Vector3(0.5f, 0.5f, 0.5f));
+
+	double setup_time = 0, raster_time = 0, threaded_time = 0, test_time = 0;
+	int num_occluded = 0;
+	for (int it = 0; it < iterations; ++it)
+	{
+		Clock::time_point start = Clock::now();
+		buffer.clear(getViewProjection());
+		for (int i = 0; i < NUM_OCCLUDERS; ++i)
+			addQuad(buffer, models[i], 2.0f);
+		setup_time += elapsedMs(start);
+
+		start = Clock::now();
+		buffer.rasterize(false);
+		raster_time += elapsedMs(start);
+
+		start = Clock::now();
+		buffer.rasterize(true);
+		threaded_time += elapsedMs(start);
+
+		start = Clock::now();
+		num_occluded = 0;
+		for (int i = 0; i < NUM_BOXES; ++i)
+			num_occluded += buffer.isOccluded(boxes[i]) ? 1 : 0;
+		test_time += elapsedMs(start);
+	}
+
+	printf("occlusion benchmark (%dx%d, %d triangles, %d boxes, %d iterations)\n", buffer.width, buffer.height, buffer.num_triangles, NUM_BOXES, iterations);
+	printf("\t setup: %.3f ms\n", setup_time / iterations);
+	printf("\t rasterize: %.3f ms, with %d threads: %.3f ms\n", raster_time / iterations, JobSystem::get()->getNumThreads(), threaded_time / iterations);
+	printf("\t test: %.3f ms, %d occluded\n", test_time / iterations, num_occluded);
+}
+
+int main(int argc, char** argv)
+{
+	testClassification(false);
+	testClassification(true);
+	testThreadsMatch();
+
+	if (num_failed)
+	{
+		printf("occlusion_test: %d checks failed\n", num_failed);
+		return 1;
+	}
+	printf("occlusion_test: ok\n");
+
+	benchmark(argc > 1 ? atoi(argv[1]) : 20);
+	return 0;
+}